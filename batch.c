@@ -0,0 +1,759 @@
+#include "batch.h"  // To access batchTotals and the batch declarations.
+#include "scan.h"   // To check each line as a grid.
+#include "pack.h"   // To read and write packed records.
+#include "lockstep.h"   // To solve groups of grids in lockstep.
+#include "ring.h"   // To hand chunks of grids between the stages, and
+                    // wait for them.
+#include <errno.h>  // To say there was no memory for the output.
+#include <pthread.h>    // To read and write on threads of their own.
+#include <stdlib.h> // To malloc() the blocks of grids.
+#include <unistd.h> // To find where the output starts, to set its count.
+
+/*===========================================================================*/
+/*===== Batch Entries. ======================================================*/
+/*===========================================================================*/
+
+#define ENTRY_INVALID 0     // The line was not a grid.
+#define ENTRY_READ 1        // The grid is read, and waiting to be solved.
+#define ENTRY_SOLVED 2      // The grid now holds its solution.
+#define ENTRY_UNSOLVABLE 3  // The grid has no solution.
+#define ENTRY_GAVE_UP 4     // The search ran out of nodes.
+#define ENTRY_TIMED_OUT 5   // The search ran out of time.
+
+// A line of the batch, and what became of it.
+typedef struct {
+    sudokuGrid game;
+    int status;
+    long count;         // The solutions found, when counting.
+    difficultyEstimate estimate;    // How hard it is, when estimating.
+    searchStats stats;  // What the search did, when writing stats.
+    long micros;        // How long it took, when writing stats.
+    long line;          // The line number it was read from.
+    int length;         // The length of the line.
+    cell badCell;       // The first cell that was not a value, or -1.
+} batchEntry;
+
+// A block of entries being solved.
+typedef struct {
+    batchEntry *entries;
+    long count;
+    const batchOptions *options;
+} batchBlock;
+
+// Reads up to size entries from a source. Returns the number read.
+typedef long (*blockReader)(void *source, batchEntry *entries, long size);
+
+// Lines of text being read, and how many so far.
+typedef struct {
+    FILE *in;
+    long line;
+} textSource;
+
+// A packed file being read, and the next record of it.
+typedef struct {
+    const packedFile *file;
+    long next;
+} packedSource;
+
+// A chunk of entries going through a pipelined batch, and its place in it.
+typedef struct {
+    batchEntry entries[BATCH_CHUNK];
+    long count;         // The entries read into it; 0 once the input ends.
+    long sequence;      // The number of the chunk, counting from 0 as read.
+} batchChunk;
+
+// The stages of a pipelined batch, and the rings between them. The reader
+// fills free chunks, the workers solve them, and the writer writes them
+// out in sequence and frees them again, so no more than capacity chunks
+// are ever read and not yet written.
+typedef struct {
+    batchChunk *chunks;
+    long capacity;      // The number of chunks.
+    longRing free;      // Chunks to read into.
+    longRing work;      // Chunks read, to solve; -1 tells a worker to stop.
+    long *order;        // The chunk of each sequence number, by its
+                        // remainder by capacity.
+    sem_t *solved;      // Posted when the chunk in the same place of order
+                        // is solved, or is the end.
+    int workers;        // The workers solving chunks.
+
+    blockReader read;
+    void *source;
+    poolTask solve;
+    const batchOptions *options;
+
+    outputWriter *writer;
+    int packed;
+    batchTotals *totals;
+} batchPipeline;
+
+/*===========================================================================*/
+/*===== Static Helper Functions. ============================================*/
+/*===========================================================================*/
+
+/*======== Line Reading and Writing ===*/
+
+// Reads a line from in into line, without its newline, and sets *length
+// to its length.
+// Returns FALSE at the end of the input; a line too long for the buffer is
+// read to its end and given back as "", with *length still its full length.
+static int readLine(FILE *in, char *line, int size, int *length) {
+    if (!fgets(line, size, in))
+        return FALSE;
+
+    *length = strlen(line);
+    if ((*length > 0) && (line[*length - 1] == '\n')) {
+        line[--(*length)] = '\0';
+
+    } else if (!feof(in)) {
+        // skip the rest of the line.
+        int c;
+        while (((c = getc(in)) != EOF) && (c != '\n'))
+            (*length)++;
+
+        line[0] = '\0';
+        return TRUE;
+    }
+
+    // allow lines ending in "\r\n".
+    if ((*length > 0) && (line[*length - 1] == '\r'))
+        line[--(*length)] = '\0';
+
+    return TRUE;
+}
+
+// Writes why entry's line or packed record was not a grid to out.
+static void reportEntry(FILE *out, const batchEntry *entry, int packed) {
+    if (packed) {
+        fprintf(out, "record %ld: cell %d has a code that is not a value\n",
+                entry->line, entry->badCell);
+    } else if (entry->length != GRID_SIZE) {
+        fprintf(out, "line %ld: %d chars, not %d\n", entry->line,
+                entry->length, GRID_SIZE);
+    } else {
+        fprintf(out, "line %ld: cell %d is '%c', not a value or '%c'\n",
+                entry->line, entry->badCell,
+                entry->game[entry->badCell], BLANK);
+    }
+}
+
+
+
+// A blockReader of textSource lines.
+static long readBlock(void *source, batchEntry *entries, long size) {
+    textSource *text = source;
+    char line[GRID_SIZE * 2];
+    long count = 0;
+    int length;
+
+    while ((count < size)
+            && (readLine(text->in, line, sizeof(line), &length))) {
+        batchEntry *entry = &entries[count];
+
+        text->line++;
+
+        // empty lines separate nothing, so don't count them.
+        if (length == 0)
+            continue;
+
+        // the line is kept, even when it isn't a grid, to say why. It is
+        // only checked here; the solver parses it as it places the givens.
+        entry->line = text->line;
+        entry->length = length;
+        entry->badCell = (length == GRID_SIZE) ? findBadCell(line) : -1;
+        entry->status = ((length == GRID_SIZE) && (entry->badCell == -1))
+            ? ENTRY_READ : ENTRY_INVALID;
+        if (length == GRID_SIZE)
+            memcpy(entry->game, line, sizeof(entry->game));
+        count++;
+    }
+
+    return count;
+}
+
+// A blockReader of packedSource records, unpacked straight from the
+// mapped file.
+static long readPackedBlock(void *source, batchEntry *entries, long size) {
+    packedSource *packed = source;
+    long count = 0;
+
+    while ((count < size) && (packed->next < packed->file->count)) {
+        batchEntry *entry = &entries[count];
+
+        entry->line = packed->next + 1;
+        entry->length = GRID_SIZE;
+        entry->badCell = unpackGrid(packedRecord(packed->file, packed->next),
+                entry->game);
+        entry->status = (entry->badCell == -1) ? ENTRY_READ : ENTRY_INVALID;
+
+        packed->next++;
+        count++;
+    }
+
+    return count;
+}
+
+// Returns the format the entries of a batch are written in: lines instead
+// of packed records when counting or estimating.
+static int entryFormat(const batchOptions *options) {
+    if ((options->outputFormat == OUTPUT_PACKED)
+            && ((options->counting) || (options->estimating)))
+        return OUTPUT_LINES;
+
+    return options->outputFormat;
+}
+
+// Returns TRUE if what each search did is needed: for the stats, or for
+// the JSON output.
+static int keepingStats(const batchOptions *options) {
+    return ((options->statsFormat != STATS_NONE)
+            || (options->outputFormat == OUTPUT_JSON));
+}
+
+// Writes the solution of entry as a packed record, or a record of BLANKs
+// if it has none.
+static void writeRecord(outputWriter *writer, const batchEntry *entry) {
+    unsigned char *record = (unsigned char *) reserveOutput(writer,
+            PACK_RECORD);
+
+    if (entry->status == ENTRY_SOLVED)
+        packGrid(entry->game, record);
+    else
+        memset(record, 0, PACK_RECORD);
+    writer->used += PACK_RECORD;
+}
+
+// Writes the line for entry, laying a solved grid out as printGrid() does
+// when pretty.
+static void writeLine(outputWriter *writer, const batchEntry *entry,
+        const batchOptions *options, int pretty) {
+    char *line;
+
+    switch (entry->status) {
+        case ENTRY_SOLVED:
+            // a count that reached the limit may have stopped short.
+            if (options->estimating) {
+                printOutput(writer, "%d %d %s\n", entry->estimate.score,
+                        entry->estimate.confidence,
+                        difficultyName(entry->estimate.level));
+            } else if (options->counting) {
+                printOutput(writer, "%ld%s\n", entry->count,
+                        ((options->countLimit)
+                         && (entry->count >= options->countLimit)) ? "+" : "");
+            } else if (pretty) {
+                line = reserveOutput(writer, GRID_TEXT_SIZE);
+                writer->used += formatGrid((value *) entry->game, line);
+            } else {
+                line = reserveOutput(writer, GRID_SIZE + 1);
+                memcpy(line, entry->game, GRID_SIZE);
+                line[GRID_SIZE] = '\n';
+                writer->used += GRID_SIZE + 1;
+            }
+            break;
+
+        case ENTRY_UNSOLVABLE:
+            if ((options->counting) && (!options->estimating))
+                putOutput(writer, "0\n", 2);
+            else
+                putOutput(writer, NO_SOLUTION_LINE "\n",
+                        sizeof(NO_SOLUTION_LINE));
+            break;
+
+        case ENTRY_GAVE_UP:
+            putOutput(writer, GAVE_UP_LINE "\n", sizeof(GAVE_UP_LINE));
+            break;
+
+        case ENTRY_TIMED_OUT:
+            putOutput(writer, TIMED_OUT_LINE "\n", sizeof(TIMED_OUT_LINE));
+            break;
+
+        default:
+            putOutput(writer, INVALID_LINE "\n", sizeof(INVALID_LINE));
+            break;
+    }
+}
+
+// Writes entry as a line of JSON: its puzzle number, its outcome, what it
+// came to, and what its search did.
+static void writeJson(outputWriter *writer, const batchEntry *entry,
+        const batchOptions *options, long puzzle, const char *outcome) {
+    char counts[STATS_JSON_SIZE];
+
+    printOutput(writer, "{\"puzzle\":%ld,\"outcome\":\"%s\"", puzzle,
+            outcome);
+
+    if (entry->status == ENTRY_SOLVED) {
+        if (options->estimating) {
+            printOutput(writer, ",\"score\":%d,\"confidence\":%d"
+                    ",\"level\":\"%s\"", entry->estimate.score,
+                    entry->estimate.confidence,
+                    difficultyName(entry->estimate.level));
+        } else if (options->counting) {
+            printOutput(writer, ",\"count\":%ld,\"atLimit\":%s",
+                    entry->count, ((options->countLimit)
+                        && (entry->count >= options->countLimit))
+                    ? "true" : "false");
+        } else {
+            printOutput(writer, ",\"solution\":\"%s\"", entry->game);
+        }
+    } else if ((entry->status == ENTRY_UNSOLVABLE) && (options->counting)
+            && (!options->estimating)) {
+        printOutput(writer, ",\"count\":0,\"atLimit\":false");
+    } else if (entry->status == ENTRY_INVALID) {
+        printOutput(writer, ",\"line\":%ld", entry->line);
+    }
+
+    formatJsonCounts(counts, &entry->stats);
+    printOutput(writer, ",\"micros\":%ld%s}\n", entry->micros, counts);
+}
+
+// Writes what became of entry, in the batch's format, and adds it to
+// totals. Packed says whether it was read from a packed file.
+static void writeEntry(outputWriter *writer, const batchEntry *entry,
+        const batchOptions *options, int packed, batchTotals *totals) {
+    const char *outcome;
+
+    totals->puzzles++;
+
+    switch (entry->status) {
+        case ENTRY_SOLVED:
+            totals->solved++;
+            outcome = "solved";
+            break;
+
+        case ENTRY_UNSOLVABLE:
+            totals->unsolvable++;
+            outcome = NO_SOLUTION_LINE;
+            break;
+
+        case ENTRY_GAVE_UP:
+            totals->gaveUp++;
+            outcome = GAVE_UP_LINE;
+            break;
+
+        case ENTRY_TIMED_OUT:
+            totals->timedOut++;
+            outcome = TIMED_OUT_LINE;
+            break;
+
+        default:
+            if (options->reportOut)
+                reportEntry(options->reportOut, entry, packed);
+            totals->invalid++;
+            outcome = INVALID_LINE;
+            break;
+    }
+
+    switch (entryFormat(options)) {
+        case OUTPUT_JSON:
+            writeJson(writer, entry, options, totals->puzzles, outcome);
+            break;
+
+        case OUTPUT_PACKED:
+            writeRecord(writer, entry);
+            break;
+
+        default:
+            writeLine(writer, entry, options,
+                    (options->outputFormat == OUTPUT_PRETTY));
+            break;
+    }
+
+    // a line that wasn't a grid has no solve to add up.
+    if (options->statsFormat != STATS_NONE) {
+        writeStats(options->statsOut, options->statsFormat, totals->puzzles,
+                outcome, &entry->stats, entry->micros);
+        if (entry->status != ENTRY_INVALID)
+            addStatsTotals(&totals->stats, &entry->stats, entry->micros);
+    }
+}
+
+
+/*======== Solving ===*/
+
+// Returns the status of an entry whose search ended with status.
+static int searchEntryStatus(int status) {
+    switch (status) {
+        case SEARCH_SOLVED:
+            return ENTRY_SOLVED;
+
+        // a search that couldn't allocate gave up before it began.
+        case SEARCH_GAVE_UP:
+        case SEARCH_NO_MEMORY:
+            return ENTRY_GAVE_UP;
+
+        case SEARCH_TIMED_OUT:
+            return ENTRY_TIMED_OUT;
+
+        default:
+            return ENTRY_UNSOLVABLE;
+    }
+}
+
+// A poolTask solving one entry of a block. It only touches its own entry.
+static void solveEntry(void *context, long index, int worker) {
+    batchBlock *block = context;
+    batchEntry *entry = &block->entries[index];
+
+    const batchOptions *options = block->options;
+    searchOptions search = options->search;
+    long start = 0;
+    int status;
+
+    (void) worker;
+    memset(&entry->stats, 0, sizeof(entry->stats));
+    entry->micros = 0;
+
+    if (entry->status == ENTRY_READ) {
+        if (keepingStats(options)) {
+            search.stats = &entry->stats;
+            start = searchMicros();
+        }
+
+        // an estimate searches nothing, so it is only solved or not.
+        if (options->estimating)
+            status = (estimateDifficulty(entry->game, &entry->estimate))
+                ? SEARCH_SOLVED : SEARCH_NO_SOLUTION;
+        else if (options->counting)
+            status = countGrid(entry->game, options->countLimit, &search,
+                    &entry->count);
+        else if (options->cache)
+            status = solveCached(options->cache, entry->game, &search);
+        else
+            status = solveGrid(entry->game, &search);
+
+        if (keepingStats(options))
+            entry->micros = searchMicros() - start;
+
+        entry->status = searchEntryStatus(status);
+    }
+}
+
+// A poolTask solving the index'th group of LOCKSTEP_LANES entries of a
+// block in lockstep. It only touches the entries of its group, each of
+// which is timed as the whole group, since none is answered before the
+// rest.
+static void solveLockstepEntries(void *context, long index, int worker) {
+    batchBlock *block = context;
+    batchEntry *group[LOCKSTEP_LANES];
+    sudokuGrid games[LOCKSTEP_LANES];
+    searchStats stats[LOCKSTEP_LANES];
+    int statuses[LOCKSTEP_LANES];
+
+    const batchOptions *options = block->options;
+    long first = index * LOCKSTEP_LANES, i, start = 0, micros = 0;
+    int count = 0, k;
+
+    (void) worker;
+    for (i = first; (i < block->count) && (i < first + LOCKSTEP_LANES); i++) {
+        batchEntry *entry = &block->entries[i];
+
+        memset(&entry->stats, 0, sizeof(entry->stats));
+        entry->micros = 0;
+        if (entry->status == ENTRY_READ) {
+            group[count] = entry;
+            memcpy(games[count], entry->game, sizeof(sudokuGrid));
+            count++;
+        }
+    }
+
+    if (keepingStats(options))
+        start = searchMicros();
+    solveLockstep(games, count, &options->search, statuses, stats);
+    if (keepingStats(options))
+        micros = searchMicros() - start;
+
+    for (k = 0; k < count; k++) {
+        batchEntry *entry = group[k];
+
+        entry->status = searchEntryStatus(statuses[k]);
+        if (entry->status == ENTRY_SOLVED)
+            memcpy(entry->game, games[k], sizeof(sudokuGrid));
+        entry->stats = stats[k];
+        entry->micros = micros;
+    }
+}
+
+// Solves block with solve, on this thread: an entry per task, or a group
+// of LOCKSTEP_LANES per task in lockstep.
+static void solveBlock(batchBlock *block, poolTask solve) {
+    long tasks = block->count, i;
+
+    if (solve == solveLockstepEntries)
+        tasks = (block->count + LOCKSTEP_LANES - 1) / LOCKSTEP_LANES;
+
+    for (i = 0; i < tasks; i++)
+        solve(block, i, 0);
+}
+
+// Solves the grids read from source by read a block at a time on this
+// thread, writing each block out before reading the next.
+static void solveSequentially(blockReader read, void *source,
+        outputWriter *writer, poolTask solve, const batchOptions *options,
+        int packed, batchTotals *totals) {
+    batchEntry *entries = malloc(BATCH_BLOCK * sizeof(*entries));
+    batchBlock block;
+    long i;
+
+    assert(entries);
+    block.entries = entries;
+    block.options = options;
+
+    while ((block.count = read(source, entries, BATCH_BLOCK)) > 0) {
+        solveBlock(&block, solve);
+
+        for (i = 0; i < block.count; i++)
+            writeEntry(writer, &entries[i], options, packed, totals);
+        flushWriter(writer);
+    }
+
+    free(entries);
+}
+
+
+/*======== Pipelining ===*/
+
+// The reader of a pipelined batch: reads the input into free chunks and
+// hands them to the workers in sequence, until it ends, and then tells the
+// writer where it ended and each worker to stop. Waits for a free chunk
+// when all of them are in use, so the input is read no faster than the
+// output is written.
+static void *readChunks(void *context) {
+    batchPipeline *pipe = context;
+    batchChunk *chunk;
+    long sequence, next;
+    int i;
+
+    for (sequence = 0; ; sequence++) {
+        next = popRing(&pipe->free);
+        chunk = &pipe->chunks[next];
+        chunk->count = pipe->read(pipe->source, chunk->entries, BATCH_CHUNK);
+        chunk->sequence = sequence;
+        pipe->order[sequence % pipe->capacity] = next;
+
+        // the end has nothing to solve, so goes straight to the writer.
+        if (chunk->count == 0) {
+            sem_post(&pipe->solved[sequence % pipe->capacity]);
+            break;
+        }
+
+        pushRing(&pipe->work, next);
+    }
+
+    for (i = 0; i < pipe->workers; i++)
+        pushRing(&pipe->work, -1);
+
+    return NULL;
+}
+
+// A poolTask solving the chunks of a pipelined batch as the reader hands
+// them out, in whatever order they come, until it says to stop. Each
+// worker runs one.
+static void solveChunks(void *context, long index, int worker) {
+    batchPipeline *pipe = context;
+    batchBlock block;
+    batchChunk *chunk;
+    long next;
+
+    (void) index;
+    (void) worker;
+    block.options = pipe->options;
+
+    while ((next = popRing(&pipe->work)) >= 0) {
+        chunk = &pipe->chunks[next];
+        block.entries = chunk->entries;
+        block.count = chunk->count;
+        solveBlock(&block, pipe->solve);
+
+        sem_post(&pipe->solved[chunk->sequence % pipe->capacity]);
+    }
+}
+
+// The writer of a pipelined batch: writes the chunks out in the order they
+// were read, as each is solved, and frees them for the reader, until the
+// end. The output is flushed whenever the next chunk isn't solved yet, so
+// it keeps up with a slow input.
+static void *writeChunks(void *context) {
+    batchPipeline *pipe = context;
+    batchChunk *chunk;
+    long sequence, next, i;
+    sem_t *solved;
+
+    for (sequence = 0; ; sequence++) {
+        solved = &pipe->solved[sequence % pipe->capacity];
+        if (sem_trywait(solved) != 0) {
+            flushWriter(pipe->writer);
+            waitSemaphore(solved);
+        }
+
+        next = pipe->order[sequence % pipe->capacity];
+        chunk = &pipe->chunks[next];
+        if (chunk->count == 0)
+            break;
+
+        for (i = 0; i < chunk->count; i++)
+            writeEntry(pipe->writer, &chunk->entries[i], pipe->options,
+                    pipe->packed, pipe->totals);
+        pushRing(&pipe->free, next);
+    }
+
+    return NULL;
+}
+
+// Frees what was set up of pipe.
+static void freePipeline(batchPipeline *pipe) {
+    long i;
+
+    if (pipe->solved)
+        for (i = 0; i < pipe->capacity; i++)
+            sem_destroy(&pipe->solved[i]);
+    if (pipe->free.slots)
+        destroyRing(&pipe->free);
+    if (pipe->work.slots)
+        destroyRing(&pipe->work);
+    free(pipe->solved);
+    free(pipe->order);
+    free(pipe->chunks);
+}
+
+// Solves the grids read from source by read on options->pool, in a
+// pipeline of chunks of BATCH_CHUNK: a thread reads them, the pool's
+// workers solve them, and another thread writes them out in order, all at
+// once. Up to BATCH_CHUNKS chunks per worker are in flight.
+// Returns FALSE, having read nothing, if the pipeline couldn't be set up.
+static int solvePipelined(blockReader read, void *source,
+        outputWriter *writer, poolTask solve, const batchOptions *options,
+        int packed, batchTotals *totals) {
+    batchPipeline pipe;
+    pthread_t reader, writerThread;
+    long i;
+    int ok;
+
+    memset(&pipe, 0, sizeof(pipe));
+    pipe.workers = poolThreads(options->pool);
+    pipe.capacity = (long) BATCH_CHUNKS * pipe.workers;
+    pipe.read = read;
+    pipe.source = source;
+    pipe.solve = solve;
+    pipe.options = options;
+    pipe.writer = writer;
+    pipe.packed = packed;
+    pipe.totals = totals;
+
+    // the work ring also holds a stop for each worker.
+    pipe.chunks = malloc(pipe.capacity * sizeof(*pipe.chunks));
+    pipe.order = malloc(pipe.capacity * sizeof(*pipe.order));
+    pipe.solved = malloc(pipe.capacity * sizeof(*pipe.solved));
+    ok = ((pipe.chunks) && (pipe.order) && (pipe.solved)
+            && (initRing(&pipe.free, pipe.capacity))
+            && (initRing(&pipe.work, pipe.capacity + pipe.workers)));
+    if (!ok) {
+        freePipeline(&pipe);
+        return FALSE;
+    }
+
+    for (i = 0; i < pipe.capacity; i++) {
+        sem_init(&pipe.solved[i], 0, 0);
+        pushRing(&pipe.free, i);
+    }
+
+    if (pthread_create(&writerThread, NULL, writeChunks, &pipe) != 0) {
+        freePipeline(&pipe);
+        return FALSE;
+    }
+    if (pthread_create(&reader, NULL, readChunks, &pipe) != 0) {
+        // the writer is waiting for the first chunk; make it the end.
+        pipe.chunks[0].count = 0;
+        pipe.order[0] = 0;
+        sem_post(&pipe.solved[0]);
+        pthread_join(writerThread, NULL);
+        freePipeline(&pipe);
+        return FALSE;
+    }
+
+    runPool(options->pool, pipe.workers, solveChunks, &pipe);
+    pthread_join(reader, NULL);
+    pthread_join(writerThread, NULL);
+
+    freePipeline(&pipe);
+    return TRUE;
+}
+
+// Solves the grids read from source by read, writing each to out in order.
+// Records is the number of grids, if it is known, or -1.
+static void solveBlocks(blockReader read, void *source, FILE *out,
+        long records, const batchOptions *options, int packed,
+        batchTotals *totals) {
+    unsigned char header[PACK_HEADER];
+    outputWriter writer;
+    long size;
+    size_t bytes;
+    off_t start;
+    poolTask solve = solveEntry;
+
+    memset(totals, 0, sizeof(*totals));
+    initStatsTotals(&totals->stats);
+
+    // only solving goes in lockstep, and not through the cache.
+    if ((options->search.engine == ENGINE_LOCKSTEP) && (!options->counting)
+            && (!options->estimating) && (!options->cache))
+        solve = solveLockstepEntries;
+
+    // the results go around out's buffer, so empty it first. The buffer
+    // holds a block, or all the chunks in flight.
+    fflush(out);
+    size = BATCH_BLOCK;
+    if (options->pool)
+        size = (long) BATCH_CHUNK * BATCH_CHUNKS * poolThreads(options->pool);
+    bytes = (size_t) size * outputEntryBytes(entryFormat(options));
+    if (!openWriter(&writer, fileno(out),
+                (bytes < BATCH_OUTPUT) ? bytes : BATCH_OUTPUT)) {
+        totals->writeError = ENOMEM;
+        return;
+    }
+
+    // a packed file's count is set at the end, if it isn't known yet.
+    start = lseek(writer.fd, 0, SEEK_CUR);
+    if (entryFormat(options) == OUTPUT_PACKED) {
+        makePackedHeader(header, (records < 0) ? 0 : records);
+        putOutput(&writer, header, PACK_HEADER);
+    }
+
+    if ((!options->pool) || (!solvePipelined(read, source, &writer, solve,
+                    options, packed, totals)))
+        solveSequentially(read, source, &writer, solve, options, packed,
+                totals);
+
+    if ((entryFormat(options) == OUTPUT_PACKED) && (records < 0)) {
+        makePackedHeader(header, totals->puzzles);
+        rewriteOutput(&writer, start, header, PACK_HEADER);
+    }
+    closeWriter(&writer);
+    totals->writeError = writer.error;
+
+    if (options->statsFormat != STATS_NONE)
+        writeStatsTotals(options->statsOut, options->statsFormat,
+                &totals->stats);
+}
+
+
+
+/*===========================================================================*/
+/*===== Public Functions. ===================================================*/
+/*===========================================================================*/
+
+void solveBatch(FILE *in, FILE *out, const batchOptions *options,
+        batchTotals *totals) {
+    textSource source = { in, 0 };
+
+    solveBlocks(readBlock, &source, out, -1, options, FALSE, totals);
+}
+
+void solvePackedBatch(const packedFile *in, FILE *out,
+        const batchOptions *options, batchTotals *totals) {
+    packedSource source = { in, 0 };
+
+    // a record is written for every one read, so the count is known.
+    solveBlocks(readPackedBlock, &source, out, in->count, options, TRUE,
+            totals);
+}
@@ -0,0 +1,113 @@
+/*=== Include Guard ===*/
+#ifndef BATCH_H
+#define BATCH_H
+
+
+/*=== Includes ===*/
+
+#include <stdio.h>      // To read and write FILE streams.
+#include "sudoku.h"     // To use sudokuGrid.
+#include "pool.h"       // To solve grids on a threadPool.
+#include "solver.h"     // To use searchOptions.
+#include "stats.h"      // To write what each solve did.
+#include "pack.h"       // To solve packed files of grids.
+#include "cache.h"      // To look up grids solved before.
+#include "difficulty.h" // To estimate how hard grids are.
+#include "output.h"     // To write the results a block at a time.
+
+
+/*=== Defines ===*/
+
+#define NO_SOLUTION_LINE "no solution"  // Written for a grid with no solution.
+#define INVALID_LINE "invalid"          // Written for a line that isn't a grid.
+#define GAVE_UP_LINE "gave up"          // Written when the nodes, or the
+                                        // memory to search, run out.
+#define TIMED_OUT_LINE "timed out"      // Written when the time runs out.
+
+#define BATCH_BLOCK 4096    // Grids read before solving them, without a pool.
+#define BATCH_CHUNK 64      // Grids handed to a worker at a time, with one.
+#define BATCH_CHUNKS 8      // Chunks in flight per worker, at most.
+#define BATCH_OUTPUT (8L << 20) // The most bytes of results buffered.
+
+
+/*=== Typedefs ===*/
+
+// How to solve a batch.
+typedef struct {
+    threadPool *pool;       // The workers to solve on, or NULL for this thread.
+    searchOptions search;   // How to search each grid.
+    int counting;           // Count the solutions, instead of solving.
+    long countLimit;        // When counting, the count to stop at, or 0.
+    int estimating;         // Estimate how hard each grid is, instead of
+                            // solving or counting.
+    int outputFormat;       // OUTPUT_LINES, OUTPUT_JSON, OUTPUT_PACKED or
+                            // OUTPUT_PRETTY.
+    int statsFormat;        // STATS_JSON or STATS_CSV, or STATS_NONE.
+    FILE *statsOut;         // Where the stats go, when there is a format.
+    FILE *reportOut;        // Where to say why lines aren't grids, or NULL.
+    solutionCache *cache;   // Solutions to look grids up in first, or NULL.
+                            // Counting doesn't use it.
+} batchOptions;
+
+// What became of the lines of a batch.
+typedef struct {
+    long puzzles;       // Lines read, not counting empty ones.
+    long solved;        // Grids with a solution.
+    long unsolvable;    // Grids with no solution.
+    long gaveUp;        // Grids that ran out of search nodes.
+    long timedOut;      // Grids that ran out of search time.
+    long invalid;       // Lines that were not a valid grid.
+    statsTotals stats;  // What the solves did, when writing stats.
+    int writeError;     // The errno of the first write of the results that
+                        // failed, ENOMEM if there was no memory to buffer
+                        // them, or 0.
+} batchTotals;
+
+
+/*=== Function Declarations ===*/
+
+// Reads grids from in, one GRID_SIZE line each in the same format as
+// readGrid(), and writes what became of each to out, in outputFormat.
+// Empty lines are skipped. With OUTPUT_LINES, this is a line for each: the
+// solved grid, or NO_SOLUTION_LINE, GAVE_UP_LINE, TIMED_OUT_LINE or
+// INVALID_LINE.
+// Lines are checked with findBadCell(), and initState() parses each grid
+// as it places the givens; with a reportOut, each INVALID_LINE also writes
+// its line number and what is wrong with it there.
+// When counting, the line for a grid is instead its number of solutions,
+// with a '+' after it if the search stopped at countLimit (so a limit of 2
+// gives "0", "1" or "2+").
+// When estimating, it is instead "SCORE CONFIDENCE LEVEL", from
+// estimateDifficulty(), with the level "easy" or "hard"; a grid whose
+// givens clash gets NO_SOLUTION_LINE.
+// OUTPUT_JSON writes an object per line instead, with the puzzle's number,
+// how it ended, its solution, count or estimate, and what its search did.
+// OUTPUT_PRETTY writes solved grids as printGrid() does, and the same lines
+// as OUTPUT_LINES for the rest. OUTPUT_PACKED writes a packed file of a
+// record per grid: its solution, or all BLANKs if it has none, gave up,
+// timed out or was invalid (the totals and stats say which); its record
+// count is set at the end, so out must be a file that can seek. When
+// counting or estimating, OUTPUT_PACKED writes lines.
+// Nothing is prompted for or printed besides the results.
+// With a statsFormat, the stats of each line are written to statsOut in
+// the same order, and their totals after the last.
+// Without a pool, grids are read in blocks of BATCH_BLOCK, each solved and
+// then written out, a block per write() of up to BATCH_OUTPUT bytes,
+// straight to out's file descriptor after anything out had buffered.
+// With a pool, reading, solving and writing run at once, as a pipeline: a
+// thread reads chunks of BATCH_CHUNK grids and hands them to the workers
+// through a lock-free ring, and another writes the solved chunks out in
+// the order they were read, flushing whenever the next isn't solved yet.
+// No more than BATCH_CHUNKS chunks per worker are read and not yet
+// written, so an endless input takes bounded memory. If the threads can't
+// be started, the batch is solved in blocks on this thread instead.
+void solveBatch(FILE *in, FILE *out, const batchOptions *options,
+        batchTotals *totals);
+
+// Solves the records of a packed file like solveBatch(), unpacking each
+// straight from the mapped file. With OUTPUT_PACKED, out needn't seek,
+// since the number of records is known.
+void solvePackedBatch(const packedFile *in, FILE *out,
+        const batchOptions *options, batchTotals *totals);
+
+#endif
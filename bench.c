@@ -0,0 +1,358 @@
+#include <stdio.h>          // To printf() the results.
+#include <stdlib.h>         // To malloc() the corpus and qsort() the times.
+#include <string.h>         // To trim the lines and tier names.
+#include <unistd.h>         // To getopt() the command line options.
+#include "sudoku.h"         // To read the grids.
+#include "solver.h"         // To solve and time them.
+#include "difficulty.h"     // To estimate how hard they are.
+#include "lockstep.h"       // To solve them in groups.
+
+#define BENCH_NODE_LIMIT 1000000L   // Nodes before a solve gives up.
+#define BENCH_MAX_GRIDS 100000      // Grids read from each file.
+#define BENCH_P99_GRIDS 100         // Fewest grids to give a p99 for.
+
+// A way of solving to time.
+typedef struct {
+	const char *name;
+	int engine;
+	int branch;
+	int propagate;
+	unsigned long long seed;	// For random orders, or 0.
+	long restartNodes;			// The Luby unit of the restarts, or 0.
+} benchConfig;
+
+// The configurations run on every tier, from the naive search up.
+static const benchConfig configs[] = {
+	{"first-cell", ENGINE_BACKTRACK, BRANCH_FIRST, FALSE},
+	{"mrv", ENGINE_BACKTRACK, BRANCH_MRV, FALSE},
+	{"mrv+random", ENGINE_BACKTRACK, BRANCH_MRV, FALSE, 1, 0},
+	{"mrv+restarts", ENGINE_BACKTRACK, BRANCH_MRV, FALSE, 1, 1000},
+	{"mrv+propagate", ENGINE_BACKTRACK, BRANCH_MRV, TRUE},
+	{"dlx", ENGINE_DLX, BRANCH_MRV, FALSE},
+	{"lockstep", ENGINE_LOCKSTEP, BRANCH_MRV, TRUE},
+};
+
+#define BENCH_CONFIGS ((int) (sizeof(configs) / sizeof(configs[0])))
+
+// What estimateDifficulty() made of a tier, and how long it took.
+typedef struct {
+	char tier[32];
+	long puzzles;
+	long hard;
+	int minScore;
+	int maxScore;
+	double medianMicros;
+	double p99Micros;		// Or -1, for too few grids.
+	double maxMicros;
+} estimateRow;
+
+// Prints how to run the program to stderr.
+static void printUsage(const char *name);
+
+// Reads the grids of the file at path into a new array.
+// Returns the number read, or -1 if the file can't be opened or has a line
+// that isn't a valid grid.
+static long readCorpus(const char *path, sudokuGrid **grids);
+
+// Solves every grid with config, and prints a line of results. Lockstep
+// grids are solved LOCKSTEP_LANES at a time, each timed as its share of
+// its group.
+// Returns the number of grids solved wrongly, or found to have no solution;
+// grids given up on are only reported.
+static long runConfig(const char *tier, const benchConfig *config,
+		const sudokuGrid *grids, long count, long nodeLimit);
+
+// Estimates the difficulty of every grid, timing each, into row.
+static void runEstimate(const char *tier, const sudokuGrid *grids, long count,
+		estimateRow *row);
+
+// Returns TRUE if solution is full, legal, and keeps the givens of game.
+static int checkSolution(const sudokuGrid game, const sudokuGrid solution);
+
+
+// Compares two long longs for qsort().
+static int compareTimes(const void *a, const void *b);
+
+// Returns the 99th percentile of count sorted times, in microseconds, or
+// -1 if there are fewer than BENCH_P99_GRIDS, when it would only be the
+// slowest.
+static double p99Micros(const long long *times, long count);
+
+// Writes micros into text, to precision decimals, or "-" if it is -1.
+static void formatMicros(char *text, size_t size, double micros,
+		int precision);
+
+/*=== Main: Time the Solvers. ===*/
+int main(int argc, char *argv[]) {
+	long nodeLimit = BENCH_NODE_LIMIT;
+	long failures = 0;
+	estimateRow *estimates;
+	int option, i, c;
+
+	while ((option = getopt(argc, argv, "l:h")) != -1) {
+		switch (option) {
+			case 'l':
+				nodeLimit = atol(optarg);
+				break;
+
+			default:
+				printUsage(argv[0]);
+				return (option == 'h') ? 0 : 2;
+		}
+	}
+
+	if (optind == argc) {
+		printUsage(argv[0]);
+		return 2;
+	}
+
+	estimates = calloc(argc, sizeof(*estimates));
+	if (!estimates)
+		return 2;
+
+	printf("%-12s %-14s %7s %6s %7s %11s %10s %10s %10s %12s\n", "tier",
+			"config", "puzzles", "failed", "gave up", "puzzles/s",
+			"median us", "p99 us", "max us", "nodes/puzzle");
+
+	for (i = optind; i < argc; i++) {
+		sudokuGrid *grids;
+		char tier[32];
+		const char *name;
+		long count;
+
+		count = readCorpus(argv[i], &grids);
+		if (count < 0)
+			return 2;
+
+		// name the tier after the file, without its directory or suffix.
+		name = strrchr(argv[i], '/');
+		snprintf(tier, sizeof(tier), "%s", (name) ? name + 1 : argv[i]);
+		tier[strcspn(tier, ".")] = '\0';
+
+		for (c = 0; c < BENCH_CONFIGS; c++)
+			failures += runConfig(tier, &configs[c], grids, count, nodeLimit);
+		runEstimate(tier, grids, count, &estimates[i]);
+
+		free(grids);
+	}
+
+	// the estimates, to check their levels against the tiers.
+	printf("\n%-12s %-14s %7s %6s %6s %9s %10s %10s %10s\n", "tier",
+			"estimate", "puzzles", "easy", "hard", "scores", "median us",
+			"p99 us", "max us");
+	for (i = optind; i < argc; i++) {
+		const estimateRow *row = &estimates[i];
+		char p99[16];
+
+		formatMicros(p99, sizeof(p99), row->p99Micros, 2);
+		printf("%-12s %-14s %7ld %6ld %6ld %4d..%-3d %10.2f %10s %10.2f\n",
+				row->tier, "difficulty", row->puzzles,
+				row->puzzles - row->hard, row->hard, row->minScore,
+				row->maxScore, row->medianMicros, p99, row->maxMicros);
+	}
+
+	free(estimates);
+	return (failures) ? 1 : 0;
+}
+
+static void printUsage(const char *name) {
+	fprintf(stderr,
+			"Usage: %s [-l NODES] FILE...\n"
+			"Times each solver configuration on the grids of each file, one\n"
+			"%d character grid per line, and prints the puzzles solved per\n"
+			"second, the median, 99th percentile and slowest time per puzzle,\n"
+			"and the mean nodes searched per puzzle. Then prints how many of\n"
+			"each file's grids estimateDifficulty() rates easy and hard, their\n"
+			"scores, and the same times per estimate. The 99th percentile of a\n"
+			"file of fewer than %d grids is left out, as only its slowest.\n"
+			"A grid solved in lockstep is timed as its whole group, since\n"
+			"they are answered together; its puzzles per second are the\n"
+			"throughput of the groups.\n"
+			"  -l NODES  give up on a grid after NODES nodes (default %ld)\n"
+			"Exits with 1 if any grid was solved wrongly, or not at all\n"
+			"without giving up.\n",
+			name, GRID_SIZE, BENCH_P99_GRIDS, BENCH_NODE_LIMIT);
+}
+
+static long readCorpus(const char *path, sudokuGrid **grids) {
+	char line[GRID_SIZE * 2];
+	FILE *in;
+	long count = 0, lineNumber = 0;
+
+	in = fopen(path, "r");
+	if (!in) {
+		perror(path);
+		return -1;
+	}
+
+	*grids = malloc(BENCH_MAX_GRIDS * sizeof(**grids));
+	if (!*grids) {
+		fclose(in);
+		return -1;
+	}
+
+	while ((count < BENCH_MAX_GRIDS) && (fgets(line, sizeof(line), in))) {
+		lineNumber++;
+		line[strcspn(line, "\r\n")] = '\0';
+		if (line[0] == '\0')
+			continue;
+
+		if (!readGrid((*grids)[count], line)) {
+			fprintf(stderr, "%s: line %ld is not a grid.\n", path, lineNumber);
+			free(*grids);
+			fclose(in);
+			return -1;
+		}
+		count++;
+	}
+
+	fclose(in);
+	return count;
+}
+
+static long runConfig(const char *tier, const benchConfig *config,
+		const sudokuGrid *grids, long count, long nodeLimit) {
+	searchOptions options;
+	searchStats stats;
+	long long *times, total = 0;
+	long nodes = 0, failed = 0, gaveUp = 0, lanes, i;
+	char p99[16];
+
+	times = malloc((count + 1) * sizeof(*times));
+	if (!times)
+		return count;
+
+	initOptions(&options);
+	options.engine = config->engine;
+	options.branch = config->branch;
+	options.propagate = config->propagate;
+	options.seed = config->seed;
+	options.restartNodes = config->restartNodes;
+	options.nodeLimit = nodeLimit;
+	options.stats = &stats;
+
+	for (i = 0; i < count; i += lanes) {
+		sudokuGrid games[LOCKSTEP_LANES];
+		searchStats laneStats[LOCKSTEP_LANES];
+		int statuses[LOCKSTEP_LANES];
+		long long start, elapsed;
+		int k;
+
+		lanes = 1;
+		if (config->engine == ENGINE_LOCKSTEP)
+			lanes = ((count - i) < LOCKSTEP_LANES) ? count - i : LOCKSTEP_LANES;
+		memcpy(games, grids[i], lanes * sizeof(sudokuGrid));
+
+		start = searchNanos();
+		if (config->engine == ENGINE_LOCKSTEP)
+			solveLockstep(games, lanes, &options, statuses, laneStats);
+		else
+			statuses[0] = solveGrid(games[0], &options);
+		elapsed = searchNanos() - start;
+
+		if (config->engine != ENGINE_LOCKSTEP)
+			laneStats[0] = stats;
+		total += elapsed;
+
+		// a lane's grid is answered with the rest of its group, so that is
+		// its latency; the throughput is in the total.
+		for (k = 0; k < lanes; k++) {
+			times[i + k] = elapsed;
+			nodes += laneStats[k].nodes;
+			if (statuses[k] == SEARCH_GAVE_UP)
+				gaveUp++;
+			else if ((statuses[k] != SEARCH_SOLVED)
+					|| (!checkSolution(grids[i + k], games[k])))
+				failed++;
+		}
+	}
+
+	qsort(times, count, sizeof(*times), compareTimes);
+	if (count == 0)
+		times[0] = 0;
+
+	formatMicros(p99, sizeof(p99), p99Micros(times, count), 1);
+	printf("%-12s %-14s %7ld %6ld %7ld %11.0f %10.1f %10s %10.1f %12.1f\n",
+			tier, config->name, count, failed, gaveUp,
+			(total) ? count / (total / 1e9) : 0.0,
+			times[count / 2] / 1e3, p99,
+			times[(count) ? count - 1 : 0] / 1e3,
+			(count) ? (double) nodes / count : 0.0);
+
+	free(times);
+	return failed;
+}
+
+static void runEstimate(const char *tier, const sudokuGrid *grids, long count,
+		estimateRow *row) {
+	difficultyEstimate estimate;
+	long long *times;
+	long i;
+
+	snprintf(row->tier, sizeof(row->tier), "%s", tier);
+	row->puzzles = count;
+	row->minScore = (count) ? 100 : 0;
+
+	times = malloc((count + 1) * sizeof(*times));
+	if (!times)
+		return;
+	times[0] = 0;
+
+	for (i = 0; i < count; i++) {
+		sudokuGrid game;
+		long long start;
+
+		memcpy(game, grids[i], sizeof(sudokuGrid));
+		start = searchNanos();
+		estimateDifficulty(game, &estimate);
+		times[i] = searchNanos() - start;
+
+		row->hard += (estimate.level == DIFFICULTY_HARD);
+		if (estimate.score < row->minScore)
+			row->minScore = estimate.score;
+		if (estimate.score > row->maxScore)
+			row->maxScore = estimate.score;
+	}
+
+	qsort(times, count, sizeof(*times), compareTimes);
+	row->medianMicros = times[count / 2] / 1e3;
+	row->p99Micros = p99Micros(times, count);
+	row->maxMicros = times[(count) ? count - 1 : 0] / 1e3;
+
+	free(times);
+}
+
+static int checkSolution(const sudokuGrid game, const sudokuGrid solution) {
+	solverState state;
+	cell i;
+
+	for (i = 0; i < GRID_SIZE; i++) {
+		if ((solution[i] == BLANK)
+				|| ((game[i] != BLANK) && (game[i] != solution[i])))
+			return FALSE;
+	}
+
+	// a full grid with no clashes is a solution.
+	return initState(&state, (value *) solution);
+}
+
+static int compareTimes(const void *a, const void *b) {
+	long long x = *(const long long *) a, y = *(const long long *) b;
+
+	return (x > y) - (x < y);
+}
+
+static double p99Micros(const long long *times, long count) {
+	if (count < BENCH_P99_GRIDS)
+		return -1;
+
+	return times[((count * 99 + 99) / 100) - 1] / 1e3;
+}
+
+static void formatMicros(char *text, size_t size, double micros,
+		int precision) {
+	if (micros < 0)
+		snprintf(text, size, "-");
+	else
+		snprintf(text, size, "%.*f", precision, micros);
+}
@@ -0,0 +1,232 @@
+#include <pthread.h>    // To share the cache between threads.
+#include <stdlib.h>     // To malloc() and free() the cache.
+#include "cache.h"      // To access solutionCache and the cache declarations.
+#include "canon.h"      // To look grids up by their canonical form.
+#include "pack.h"       // To keep the grids packed.
+
+/*===========================================================================*/
+/*===== Cache Structures. ===================================================*/
+/*===========================================================================*/
+
+#define NO_ENTRY (-1L)      // The end of a bucket's chain, or of the list.
+
+// A canonical grid and its solution, packed.
+typedef struct {
+    unsigned char grid[PACK_RECORD];
+    unsigned char solution[PACK_RECORD];
+    int solved;         // FALSE if the grid has no solution.
+    long chain;         // The next entry in the same bucket.
+    long newer;         // The entry used next after this one.
+    long older;         // The entry used last before this one.
+} cacheEntry;
+
+struct solutionCache {
+    pthread_mutex_t lock;   // Guards everything below.
+    cacheEntry *entries;
+    long *buckets;          // The first entry hashing to each bucket.
+    long bucketMask;        // The number of buckets, less one.
+    long newest;            // The ends of the list of entries, by last use.
+    long oldest;
+    cacheCounts counts;
+};
+
+
+
+/*===========================================================================*/
+/*===== Static Helper Functions. ============================================*/
+/*===========================================================================*/
+
+// Returns the bucket of a packed grid, by its FNV-1a hash.
+static long bucketOf(const solutionCache *cache, const unsigned char *grid) {
+    unsigned long long hash = 14695981039346656037ULL;
+    int i;
+
+    for (i = 0; i < PACK_RECORD; i++)
+        hash = (hash ^ grid[i]) * 1099511628211ULL;
+
+    return (long) (hash & cache->bucketMask);
+}
+
+// Takes entry i out of the list of entries by last use.
+static void unlinkEntry(solutionCache *cache, long i) {
+    cacheEntry *entry = &cache->entries[i];
+
+    if (entry->newer != NO_ENTRY)
+        cache->entries[entry->newer].older = entry->older;
+    else
+        cache->newest = entry->older;
+
+    if (entry->older != NO_ENTRY)
+        cache->entries[entry->older].newer = entry->newer;
+    else
+        cache->oldest = entry->newer;
+}
+
+// Puts entry i at the newest end of the list of entries by last use.
+static void linkNewest(solutionCache *cache, long i) {
+    cacheEntry *entry = &cache->entries[i];
+
+    entry->newer = NO_ENTRY;
+    entry->older = cache->newest;
+    if (cache->newest != NO_ENTRY)
+        cache->entries[cache->newest].newer = i;
+    else
+        cache->oldest = i;
+    cache->newest = i;
+}
+
+// Returns the entry holding a packed grid, or NO_ENTRY.
+static long findEntry(const solutionCache *cache, const unsigned char *grid) {
+    long i;
+
+    for (i = cache->buckets[bucketOf(cache, grid)]; i != NO_ENTRY;
+            i = cache->entries[i].chain) {
+        if (memcmp(cache->entries[i].grid, grid, PACK_RECORD) == 0)
+            return i;
+    }
+
+    return NO_ENTRY;
+}
+
+// Returns a free entry, dropping the oldest used one if the cache is full.
+static long takeEntry(solutionCache *cache) {
+    long i, *link;
+
+    if (cache->counts.entries < cache->counts.capacity)
+        return cache->counts.entries++;
+
+    // unchain the oldest from its bucket.
+    i = cache->oldest;
+    unlinkEntry(cache, i);
+    for (link = &cache->buckets[bucketOf(cache, cache->entries[i].grid)];
+            *link != i; link = &cache->entries[*link].chain)
+        ;
+    *link = cache->entries[i].chain;
+
+    cache->counts.evictions++;
+    return i;
+}
+
+
+
+/*===========================================================================*/
+/*===== Public Functions. ===================================================*/
+/*===========================================================================*/
+
+solutionCache *createCache(long capacity) {
+    solutionCache *cache;
+    long buckets = 1, i;
+
+    if (capacity < 1)
+        return NULL;
+
+    // at least two buckets an entry, to keep the chains short.
+    while (buckets < capacity * 2)
+        buckets *= 2;
+
+    cache = calloc(1, sizeof(*cache));
+    if (!cache)
+        return NULL;
+
+    cache->entries = malloc(capacity * sizeof(*cache->entries));
+    cache->buckets = malloc(buckets * sizeof(*cache->buckets));
+    if ((!cache->entries) || (!cache->buckets)) {
+        free(cache->entries);
+        free(cache->buckets);
+        free(cache);
+        return NULL;
+    }
+
+    for (i = 0; i < buckets; i++)
+        cache->buckets[i] = NO_ENTRY;
+    cache->bucketMask = buckets - 1;
+    cache->newest = NO_ENTRY;
+    cache->oldest = NO_ENTRY;
+    cache->counts.capacity = capacity;
+    pthread_mutex_init(&cache->lock, NULL);
+
+    return cache;
+}
+
+void destroyCache(solutionCache *cache) {
+    pthread_mutex_destroy(&cache->lock);
+    free(cache->entries);
+    free(cache->buckets);
+    free(cache);
+}
+
+int solveCached(solutionCache *cache, sudokuGrid game,
+        const searchOptions *options) {
+    unsigned char grid[PACK_RECORD], solution[PACK_RECORD];
+    sudokuGrid canonical;
+    gridTransform transform;
+    int status = SEARCH_GAVE_UP;    // not found, until it is.
+    long i;
+
+    canonicalGrid(game, canonical, &transform);
+    packGrid(canonical, grid);
+
+    pthread_mutex_lock(&cache->lock);
+    i = findEntry(cache, grid);
+    if (i != NO_ENTRY) {
+        cacheEntry *entry = &cache->entries[i];
+
+        status = (entry->solved) ? SEARCH_SOLVED : SEARCH_NO_SOLUTION;
+        memcpy(solution, entry->solution, PACK_RECORD);
+        unlinkEntry(cache, i);
+        linkNewest(cache, i);
+        cache->counts.hits++;
+    } else {
+        cache->counts.misses++;
+    }
+    pthread_mutex_unlock(&cache->lock);
+
+    // a hit maps the canonical grid's solution back to this one.
+    if (status != SEARCH_GAVE_UP) {
+        if ((options) && (options->stats))
+            memset(options->stats, 0, sizeof(*options->stats));
+        if (status == SEARCH_SOLVED) {
+            unpackGrid(solution, canonical);
+            invertTransform(&transform, canonical, game);
+        }
+        return status;
+    }
+
+    status = solveGrid(game, options);
+    if (!SEARCH_OVER(status))
+        return status;
+
+    memset(solution, 0, PACK_RECORD);
+    if (status == SEARCH_SOLVED) {
+        applyTransform(&transform, game, canonical);
+        packGrid(canonical, solution);
+    }
+
+    // another thread may have added it while this one was solving.
+    pthread_mutex_lock(&cache->lock);
+    i = findEntry(cache, grid);
+    if (i == NO_ENTRY) {
+        long bucket = bucketOf(cache, grid);
+        cacheEntry *entry;
+
+        i = takeEntry(cache);
+        entry = &cache->entries[i];
+        memcpy(entry->grid, grid, PACK_RECORD);
+        memcpy(entry->solution, solution, PACK_RECORD);
+        entry->solved = (status == SEARCH_SOLVED);
+        entry->chain = cache->buckets[bucket];
+        cache->buckets[bucket] = i;
+    } else {
+        unlinkEntry(cache, i);
+    }
+    linkNewest(cache, i);
+    pthread_mutex_unlock(&cache->lock);
+
+    return status;
+}
+
+void getCacheCounts(solutionCache *cache, cacheCounts *counts) {
+    pthread_mutex_lock(&cache->lock);
+    *counts = cache->counts;
+    pthread_mutex_unlock(&cache->lock);
+}
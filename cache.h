@@ -0,0 +1,51 @@
+/*=== Include Guard ===*/
+#ifndef CACHE_H
+#define CACHE_H
+
+
+/*=== Includes ===*/
+
+#include "sudoku.h"     // To use sudokuGrid.
+#include "solver.h"     // To solve the grids that miss.
+
+
+/*=== Typedefs ===*/
+
+// What a cache has done, and how full it is.
+typedef struct {
+    long hits;          // Grids whose canonical form was in the cache.
+    long misses;        // Grids that had to be solved.
+    long evictions;     // Entries dropped for new ones, oldest used first.
+    long entries;       // Entries held.
+    long capacity;      // The most entries it holds.
+} cacheCounts;
+
+// The solutions of canonical grids (see canon.h), the least recently used
+// dropped first once it is full. It may be shared between threads.
+// Defined in cache.c.
+typedef struct solutionCache solutionCache;
+
+
+/*=== Function Declarations ===*/
+
+// Makes an empty cache of up to capacity entries.
+// Returns NULL if capacity is less than 1 or there is no memory for it.
+solutionCache *createCache(long capacity);
+
+// Frees a cache.
+void destroyCache(solutionCache *cache);
+
+// Solves a valid grid in place like solveGrid(), first looking up its
+// canonical form in the cache. On a hit the cached solution is mapped back
+// to the grid, and no nodes are searched; on a miss the grid is solved,
+// and its solution (or that it has none) added. Grids given up on or timed
+// out aren't added, since another budget might solve them.
+// Returns SEARCH_SOLVED, SEARCH_NO_SOLUTION, SEARCH_GAVE_UP or
+// SEARCH_TIMED_OUT.
+int solveCached(solutionCache *cache, sudokuGrid game,
+        const searchOptions *options);
+
+// Puts what the cache has done so far in counts.
+void getCacheCounts(solutionCache *cache, cacheCounts *counts);
+
+#endif
@@ -0,0 +1,408 @@
+#include <pthread.h>    // To keep the survivors per thread.
+#include <stdlib.h>     // To malloc() the survivors.
+#include "canon.h"      // To access gridTransform and the canon declarations.
+
+/*===========================================================================*/
+/*===== Transforms Being Built. =============================================*/
+/*===========================================================================*/
+
+// The orders of GRID_SUB_LENGTH things.
+#if GRID_SUB_LENGTH == 2
+#define SUB_ORDERS 2
+#elif GRID_SUB_LENGTH == 3
+#define SUB_ORDERS 6
+#elif GRID_SUB_LENGTH == 4
+#define SUB_ORDERS 24
+#else
+#define SUB_ORDERS 120
+#endif
+
+// The rows of a band, as a mask of rows.
+#define BAND_ROWS(band) \
+    ((((1u << GRID_SUB_LENGTH) - 1)) << ((band) * GRID_SUB_LENGTH))
+
+// A value's code: its VALUE_INDEX() + 1, or 0 for BLANK.
+#define CODE_OF(v) (((v) == BLANK) ? 0 : VALUE_INDEX(v) + 1)
+
+// Sorts a value not yet labelled after every label.
+#define NEW_VALUE 0xff
+
+// A transform with its first rows placed, tied with the others for the
+// smallest of them so far. Its transposition and the order of its stacks
+// are chosen, but columns of a stack that are BLANK in every row placed so
+// far could still go in any order; they are kept together, as a class.
+typedef struct {
+    gridTransform transform;
+    unsigned int placed;                // Bit r is set once row r is placed.
+    unsigned char nextLabel;            // The label the next new value gets.
+    unsigned char tied[GRID_LENGTH];    // Set if the column is in the same
+                                        // class as the one before it.
+} canonSurvivor;
+
+// The survivors placing a row, and the smallest placing of it so far.
+typedef struct {
+    canonSurvivor *survivors;
+    int count;
+    unsigned char best[GRID_LENGTH];
+    int exact;          // FALSE once a tie has been dropped.
+} canonBeam;
+
+// Each thread's survivors, of the rows placed so far and the next, only
+// allocated on the threads that canonicalize.
+static pthread_key_t survivorsKey;
+static pthread_once_t survivorsKeyOnce = PTHREAD_ONCE_INIT;
+
+
+
+/*===========================================================================*/
+/*===== Static Helper Functions. ============================================*/
+/*===========================================================================*/
+
+static void makeSurvivorsKey(void) {
+    pthread_key_create(&survivorsKey, free);
+}
+
+// Returns this thread's two arrays of CANON_SURVIVORS survivors, allocated
+// the first time it is asked for, or NULL if they couldn't be.
+static canonSurvivor *threadSurvivors(void) {
+    canonSurvivor *survivors;
+
+    pthread_once(&survivorsKeyOnce, makeSurvivorsKey);
+    survivors = pthread_getspecific(survivorsKey);
+    if (!survivors) {
+        survivors = malloc(2 * CANON_SURVIVORS * sizeof(*survivors));
+        if (!survivors)
+            return NULL;
+        pthread_setspecific(survivorsKey, survivors);
+    }
+
+    return survivors;
+}
+
+// Steps the count things at order to their next order, in lexicographic
+// order.
+// Returns FALSE, with them back in ascending order, after the last.
+static int nextOrder(unsigned char *order, int count) {
+    unsigned char swap;
+    int more;
+    int i, j;
+
+    for (i = count - 2; (i >= 0) && (order[i] > order[i + 1]); i--)
+        ;
+
+    more = (i >= 0);
+    if (more) {
+        for (j = count - 1; order[j] < order[i]; j--)
+            ;
+        swap = order[i], order[i] = order[j], order[j] = swap;
+    }
+
+    for (i++, j = count - 1; i < j; i++, j--)
+        swap = order[i], order[i] = order[j], order[j] = swap;
+
+    return more;
+}
+
+// Puts the clues (values, not BLANKs) in each stack of row in clues.
+// Returns the smallest the row can be made by ordering its stacks and
+// columns, as a bit per column, set for a clue, from the highest bit: the
+// stacks with the fewest clues first, each with its BLANKs first.
+static unsigned int rowPattern(const unsigned char *row, int *clues) {
+    int sorted[GRID_SUB_LENGTH];
+    unsigned int pattern = 0;
+    int i, j;
+
+    for (i = 0; i < GRID_SUB_LENGTH; i++) {
+        int count = 0;
+
+        for (j = 0; j < GRID_SUB_LENGTH; j++)
+            count += (row[(i * GRID_SUB_LENGTH) + j] != 0);
+        clues[i] = count;
+
+        // insert it among the counts so far.
+        for (j = i; (j > 0) && (sorted[j - 1] > count); j--)
+            sorted[j] = sorted[j - 1];
+        sorted[j] = count;
+    }
+
+    for (i = 0; i < GRID_SUB_LENGTH; i++) {
+        pattern <<= GRID_SUB_LENGTH;
+        pattern |= (1u << sorted[i]) - 1;
+    }
+
+    return pattern;
+}
+
+// Adds next to the beam once for every order of the columns of each group
+// of new values in it, the groups running from starts to ends; placed is
+// the placed row, whose labels the new values take in turn.
+static void addSurvivors(canonBeam *beam, canonSurvivor *next,
+        const unsigned char *row, const unsigned char *placed,
+        const int *starts, const int *ends, int groups) {
+    gridTransform *transform = &next->transform;
+    int g, j;
+
+    while (TRUE) {
+        if (beam->count == CANON_SURVIVORS) {
+            beam->exact = FALSE;
+            return;
+        }
+        beam->survivors[beam->count++] = *next;
+
+        // step the last group, and the one before it when it wraps round.
+        for (g = groups - 1; g >= 0; g--) {
+            int more = nextOrder(&transform->columns[starts[g]],
+                    ends[g] - starts[g]);
+
+            for (j = starts[g]; j < ends[g]; j++)
+                transform->labels[row[transform->columns[j]]] = placed[j];
+            if (more)
+                break;
+        }
+        if (g < 0)
+            return;
+    }
+}
+
+// Places row r, of the cells in row, as row k of survivor, if it is no
+// more than the beam's smallest placing. Each class of columns is put in
+// order of its values: BLANKs first, then labelled values, then new
+// values, which are labelled in turn. The BLANKs stay a class; every order
+// of the new values' columns ties, so each gets a survivor.
+static void placeRow(const canonSurvivor *survivor, const unsigned char *row,
+        cell r, int k, canonBeam *beam) {
+    canonSurvivor next = *survivor;
+    unsigned char *columns = next.transform.columns;
+    unsigned char *labels = next.transform.labels;
+    unsigned char keys[GRID_LENGTH], placed[GRID_LENGTH];
+    int starts[GRID_LENGTH], ends[GRID_LENGTH];
+    int groups = 0, order = 0;
+    int a, b, i, j;
+
+    for (a = 0; a < GRID_LENGTH; a = b) {
+        int firstNew = -1;
+
+        for (b = a + 1; (b < GRID_LENGTH) && (next.tied[b]); b++)
+            ;
+
+        // sort the class by value, keeping columns in order among equals.
+        for (i = a; i < b; i++) {
+            unsigned char column = columns[i];
+            unsigned char code = row[column];
+            unsigned char key = (!code) ? 0
+                : (labels[code]) ? labels[code] : NEW_VALUE;
+
+            for (j = i; (j > a) && (keys[j - 1] > key); j--) {
+                keys[j] = keys[j - 1];
+                columns[j] = columns[j - 1];
+            }
+            keys[j] = key;
+            columns[j] = column;
+        }
+
+        for (i = a; i < b; i++) {
+            next.tied[i] = (i > a) && (keys[i] == 0) && (keys[i - 1] == 0);
+
+            if (keys[i] == NEW_VALUE) {
+                if (firstNew < 0)
+                    firstNew = i;
+                labels[row[columns[i]]] = next.nextLabel++;
+            }
+            placed[i] = labels[row[columns[i]]];
+
+            if (!order) {
+                order = placed[i] - beam->best[i];
+                if (order > 0)
+                    return;
+            }
+        }
+
+        // the new values are last in the class, so run to its end.
+        if ((firstNew >= 0) && (b - firstNew > 1)) {
+            starts[groups] = firstNew;
+            ends[groups++] = b;
+        }
+    }
+
+    // a smaller row drops the survivors so far.
+    if (order < 0) {
+        beam->count = 0;
+        memcpy(beam->best, placed, sizeof(beam->best));
+    }
+
+    next.transform.rows[k] = r;
+    next.placed |= (1u << r);
+    addSurvivors(beam, &next, row, placed, starts, ends, groups);
+}
+
+
+
+/*===========================================================================*/
+/*===== Public Functions. ===================================================*/
+/*===========================================================================*/
+
+int canonicalGrid(const sudokuGrid game, sudokuGrid canonical,
+        gridTransform *transform) {
+    unsigned char orders[SUB_ORDERS][GRID_SUB_LENGTH];
+    unsigned char codes[2][GRID_SIZE];  // the grid, then transposed.
+    unsigned int bestPattern = ~0u;
+    canonSurvivor *survivors = threadSurvivors();
+    canonSurvivor *from = survivors, *swap;
+    canonSurvivor base = {{0}};
+    canonBeam beam;
+    int clues[GRID_SUB_LENGTH];
+    int t, k, s, o, i;
+    cell r;
+
+    // without survivors, the grid is its own form, through the identity.
+    if (!survivors) {
+        for (i = 0; i < GRID_LENGTH; i++) {
+            transform->rows[i] = i;
+            transform->columns[i] = i;
+        }
+        for (i = 0; i <= GRID_LENGTH; i++)
+            transform->labels[i] = i;
+        transform->transposed = FALSE;
+        applyTransform(transform, game, canonical);
+        return FALSE;
+    }
+
+    for (i = 0; i < GRID_SUB_LENGTH; i++)
+        orders[0][i] = i;
+    for (o = 1; o < SUB_ORDERS; o++) {
+        memcpy(orders[o], orders[o - 1], sizeof(orders[o]));
+        nextOrder(orders[o], GRID_SUB_LENGTH);
+    }
+
+    for (i = 0; i < GRID_SIZE; i++) {
+        codes[0][i] = CODE_OF(game[i]);
+        codes[1][((i % GRID_LENGTH) * GRID_LENGTH) + (i / GRID_LENGTH)] =
+            codes[0][i];
+    }
+
+    beam.survivors = survivors + CANON_SURVIVORS;
+    beam.count = 0;
+    beam.exact = TRUE;
+    memset(beam.best, 0xff, sizeof(beam.best));
+
+    // the first row is one of those with the fewest, leftmost clues, with
+    // its stacks in any order that puts the fewest clues first, and each
+    // stack's columns a class.
+    for (t = 0; t < 2; t++) {
+        for (r = 0; r < GRID_LENGTH; r++) {
+            unsigned int pattern = rowPattern(&codes[t][r * GRID_LENGTH],
+                    clues);
+            if (pattern < bestPattern)
+                bestPattern = pattern;
+        }
+    }
+
+    base.nextLabel = 1;
+    for (i = 0; i < GRID_LENGTH; i++)
+        base.tied[i] = ((i % GRID_SUB_LENGTH) != 0);
+
+    for (t = 0; t < 2; t++) {
+        for (r = 0; r < GRID_LENGTH; r++) {
+            const unsigned char *row = &codes[t][r * GRID_LENGTH];
+
+            if (rowPattern(row, clues) != bestPattern)
+                continue;
+
+            for (o = 0; o < SUB_ORDERS; o++) {
+                for (i = 1; i < GRID_SUB_LENGTH; i++) {
+                    if (clues[orders[o][i - 1]] > clues[orders[o][i]])
+                        break;
+                }
+                if (i < GRID_SUB_LENGTH)
+                    continue;
+
+                base.transform.transposed = t;
+                for (i = 0; i < GRID_LENGTH; i++) {
+                    base.transform.columns[i] = (i % GRID_SUB_LENGTH)
+                        + (orders[o][i / GRID_SUB_LENGTH] * GRID_SUB_LENGTH);
+                }
+                placeRow(&base, row, r, 0, &beam);
+            }
+        }
+    }
+
+    // every other row keeps only the survivors that place it smallest: the
+    // rest of the first row's band, then any row of an unused band.
+    for (k = 1; k < GRID_LENGTH; k++) {
+        int count = beam.count;
+
+        swap = from, from = beam.survivors, beam.survivors = swap;
+        beam.count = 0;
+        memset(beam.best, 0xff, sizeof(beam.best));
+
+        for (s = 0; s < count; s++) {
+            const canonSurvivor *survivor = &from[s];
+            const unsigned char *rows = codes[survivor->transform.transposed];
+            unsigned int candidates = 0;
+
+            if (k % GRID_SUB_LENGTH == 0) {
+                for (i = 0; i < GRID_SUB_LENGTH; i++) {
+                    if (!(survivor->placed & BAND_ROWS(i)))
+                        candidates |= BAND_ROWS(i);
+                }
+            } else {
+                candidates = BAND_ROWS(survivor->transform.rows[k - 1]
+                        / GRID_SUB_LENGTH) & ~survivor->placed;
+            }
+
+            for (r = 0; r < GRID_LENGTH; r++) {
+                if (candidates & (1u << r))
+                    placeRow(survivor, &rows[r * GRID_LENGTH], r, k, &beam);
+            }
+        }
+    }
+
+    *transform = beam.survivors[0].transform;
+
+    // the values not in the grid take the labels left over, in order.
+    for (i = 1, k = beam.survivors[0].nextLabel; i <= GRID_LENGTH; i++) {
+        if (!transform->labels[i])
+            transform->labels[i] = k++;
+    }
+
+    applyTransform(transform, game, canonical);
+    return beam.exact;
+}
+
+void applyTransform(const gridTransform *transform, const sudokuGrid game,
+        sudokuGrid out) {
+    cell i, j;
+
+    for (i = 0; i < GRID_LENGTH; i++) {
+        for (j = 0; j < GRID_LENGTH; j++) {
+            cell from = (transform->transposed)
+                ? (transform->columns[j] * GRID_LENGTH) + transform->rows[i]
+                : (transform->rows[i] * GRID_LENGTH) + transform->columns[j];
+            unsigned char code = transform->labels[CODE_OF(game[from])];
+
+            out[(i * GRID_LENGTH) + j] = (code) ? INDEX_VALUE(code - 1) : BLANK;
+        }
+    }
+    out[GRID_SIZE] = '\0';
+}
+
+void invertTransform(const gridTransform *transform, const sudokuGrid out,
+        sudokuGrid game) {
+    unsigned char inverse[GRID_LENGTH + 1];
+    cell i, j;
+
+    for (i = 0; i <= GRID_LENGTH; i++)
+        inverse[transform->labels[i]] = i;
+
+    for (i = 0; i < GRID_LENGTH; i++) {
+        for (j = 0; j < GRID_LENGTH; j++) {
+            cell to = (transform->transposed)
+                ? (transform->columns[j] * GRID_LENGTH) + transform->rows[i]
+                : (transform->rows[i] * GRID_LENGTH) + transform->columns[j];
+            unsigned char code = inverse[CODE_OF(out[(i * GRID_LENGTH) + j])];
+
+            game[to] = (code) ? INDEX_VALUE(code - 1) : BLANK;
+        }
+    }
+    game[GRID_SIZE] = '\0';
+}
@@ -0,0 +1,59 @@
+/*=== Include Guard ===*/
+#ifndef CANON_H
+#define CANON_H
+
+
+/*=== Includes ===*/
+
+#include "sudoku.h"     // To use sudokuGrid and the grid size.
+
+
+/*=== Defines ===*/
+
+// The most transforms tied for the smallest grid so far that are followed
+// when canonicalizing. Past it the rest are dropped, and the form found may
+// differ between grids that are the same up to symmetry.
+#define CANON_SURVIVORS 2048
+
+
+/*=== Typedefs ===*/
+
+// A symmetry of the grid. Cell (i, j) of the transformed grid is cell
+// (rows[i], columns[j]) of the grid, after transposing it if transposed,
+// with its value relabelled: a value with VALUE_INDEX() v becomes the one
+// with VALUE_INDEX() labels[v + 1] - 1 (labels[0] is 0, for BLANK).
+// The rows keep to their bands and the columns to their stacks, so the
+// transformed grid has the same solutions, transformed.
+typedef struct {
+    unsigned char transposed;
+    unsigned char rows[GRID_LENGTH];
+    unsigned char columns[GRID_LENGTH];
+    unsigned char labels[GRID_LENGTH + 1];
+} gridTransform;
+
+
+/*=== Function Declarations ===*/
+
+// Finds the canonical form of game: the smallest grid, read row by row
+// with BLANK before every value, that any transform of game gives. Every
+// transposition, order of bands, rows within bands, stacks and columns
+// within stacks, and relabelling of the values is taken into account, so
+// the same puzzle given any of these ways has the same canonical form.
+// The canonical grid is put in canonical, and the transform to it in
+// transform.
+// Returns TRUE, or FALSE if more than CANON_SURVIVORS transforms tied and
+// the form may not be the same for all of them, or if the survivors
+// couldn't be allocated and it is game itself; either way it is still a
+// transform of game.
+int canonicalGrid(const sudokuGrid game, sudokuGrid canonical,
+        gridTransform *transform);
+
+// Puts game transformed by transform in out.
+void applyTransform(const gridTransform *transform, const sudokuGrid game,
+        sudokuGrid out);
+
+// Undoes transform: puts the grid that transform turns into out in game.
+void invertTransform(const gridTransform *transform, const sudokuGrid out,
+        sudokuGrid game);
+
+#endif
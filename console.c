@@ -0,0 +1,83 @@
+#include "console.h"    // To access the console declarations.
+
+/*===========================================================================*/
+/*===== Static Helper Functions. ============================================*/
+/*===========================================================================*/
+
+/*======== Console Table Helper ===*/
+
+static void printTableBorder() {
+    int i;
+
+    // a border as wide as the row numbers, then as the row of values.
+    printf("+-----+");
+    for (i = 0; i < (GRID_LENGTH * 2) + 3; i++)
+        printf("-");
+    printf("+\n");
+}
+
+
+
+/*===========================================================================*/
+/*===== Public Functions. ===================================================*/
+/*===========================================================================*/
+
+int readGridFromConsole(sudokuGrid game) {
+    cell i, j;                                  // iteration variables.
+    value inGrid [GRID_LENGTH + 1] = {0};       // a row.
+    value temp [(GRID_LENGTH * 2) + 1] = {0};   // a row with whitespace and \n
+
+    // print a prompt.
+    printf("+=== ENTER A SUDOKU GRID: ===+\n");
+    printf("+=== %d CELLS, SEPARATED BY SPACES; ===+\n", GRID_LENGTH);
+    printf("+=== PRESS ENTER TO GO TO THE NEXT ROW. ===+\n\n");
+    printTableBorder();
+    printf("|  #  |  ");
+    for (i = 0; i < GRID_LENGTH; i++)
+        printf("%c ", INDEX_VALUE(i)); // the column headings.
+    printf(" |\n");
+    printTableBorder();
+
+    // read the grid from the terminal, row by row.
+    for (i = 0; i < GRID_LENGTH; i++) {
+
+        // get the grid row with formatting spaces from the user.
+        printf("|  %-2d |  ", i + 1); // a prompt.
+        fgets(temp, (GRID_LENGTH * 2) + 1, stdin);
+
+        // null-terminate ('\0') the string if it ends with a newline.
+        if (temp [strlen(temp) - 1] == '\n')
+            temp [strlen(temp) - 1] = '\0';
+
+        // iterate over every other char, thus skipping spaces.
+        for (j = 0; j < (GRID_LENGTH * 2); j += 2)
+            inGrid[j / 2] = temp[j]; // assign the values, without whitespace.
+
+        // concat the row to the game.
+        strncat(game, inGrid, (size_t) GRID_LENGTH);
+    }
+    printTableBorder(); // end of grid table.
+
+    // validate grid.
+    if (!isValid(game))
+        return FALSE;
+
+    // return, based on the validity of the read game.
+    return TRUE;
+}
+
+int printGrid(sudokuGrid game) {
+    char text[GRID_TEXT_SIZE];
+    int length;
+
+    // format the whole grid first, to print it in one go.
+    length = formatGrid(game, text);
+    if (!length) {
+
+        // grid was not valid, so could not be printed.
+        return FALSE;
+    }
+
+    fwrite(text, 1, length, stdout);
+    return TRUE;
+}
@@ -0,0 +1,26 @@
+/*=== Include Guard ===*/
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+
+/*=== Includes ===*/
+
+#include "sudoku.h"     // To use sudokuGrid.
+
+
+/*=== Function Declarations ===*/
+
+// The grid functions that read from and print to the terminal, kept apart
+// so that the library can leave them out.
+
+// Reads a grid from the console, while checking that values passed are
+// valid in a sudokuGrid and that the grid ends up the correct length.
+// Returns TRUE or FALSE based on success.
+int readGridFromConsole(sudokuGrid game);
+
+// Checks that a grid is valid, then prints it to the terminal, formatted as
+// formatGrid() does, with a single write.
+// Returns TRUE or FALSE based on success.
+int printGrid(sudokuGrid game);
+
+#endif
@@ -0,0 +1,149 @@
+#include "difficulty.h" // To access difficultyEstimate and the declarations.
+#include "solver.h"     // To use candidateMask.
+#include "tables.h"     // To walk the cells of each unit.
+#include <stdlib.h>     // To abs() the distance from the boundary.
+
+/*===========================================================================*/
+/*===== Static Helper Functions. ============================================*/
+/*===========================================================================*/
+
+// Returns the number of values in mask, without a call into the runtime
+// library, which __builtin_popcount() makes where the CPU's instruction
+// isn't built in, and which would cost more than the rest of the estimate.
+static inline int countValues(candidateMask mask) {
+    mask = mask - ((mask >> 1) & 0x55555555u);
+    mask = (mask & 0x33333333u) + ((mask >> 2) & 0x33333333u);
+    mask = (mask + (mask >> 4)) & 0x0f0f0f0fu;
+    return (int) ((mask * 0x01010101u) >> 24);
+}
+
+// Builds the values free in each unit of game into unitFree: the first
+// GRID_LENGTH units are the rows, then the columns, then the sub-grids.
+// This is initState() without its checks of each move, and without a
+// branch on whether each cell is BLANK, which it could only guess.
+// Returns FALSE if two givens clash.
+static int buildUnitMasks(sudokuGrid game, candidateMask *unitFree) {
+    candidateMask clashes = 0;
+    int unit;
+    cell i;
+
+    for (unit = 0; unit < GRID_UNITS; unit++)
+        unitFree[unit] = ALL_CANDIDATES;
+
+    for (i = 0; i < GRID_SIZE; i++) {
+        candidateMask *row, *column, *subGrid, bit;
+        int given = (game[i] != BLANK);
+
+        // a BLANK cell takes nothing, and shifts by 0.
+        row = &unitFree[cellRows[i]];
+        column = &unitFree[GRID_LENGTH + cellColumns[i]];
+        subGrid = &unitFree[(GRID_LENGTH * 2) + cellSubGrids[i]];
+        bit = ((candidateMask) given << (VALUE_INDEX(game[i]) * given));
+        clashes |= (bit & ~(*row & *column & *subGrid));
+
+        *row &= ~bit;
+        *column &= ~bit;
+        *subGrid &= ~bit;
+    }
+
+    return (!clashes);
+}
+
+// Counts the hidden singles of the grid: the values with a single cell
+// left in a unit, given the candidates of each cell and the values free in
+// each unit. A cell can be counted more than once.
+// Returns the count, or -1 if a value has no cell left in some unit.
+static int countHiddenSingles(const candidateMask *unitFree,
+        const candidateMask *candidates) {
+    int unit, k, count = 0;
+
+    for (unit = 0; unit < GRID_UNITS; unit++) {
+        candidateMask once = 0, twice = 0;
+
+        for (k = 0; k < GRID_LENGTH; k++) {
+            candidateMask found = candidates[unitCells[unit][k]];
+
+            twice |= (once & found);
+            once |= found;
+        }
+
+        if (unitFree[unit] & ~once)
+            return -1;
+        count += countValues(once & ~twice);
+    }
+
+    return count;
+}
+
+
+
+/*===========================================================================*/
+/*===== Public Functions. ===================================================*/
+/*===========================================================================*/
+
+int estimateDifficulty(sudokuGrid game, difficultyEstimate *estimate) {
+    candidateMask candidates[GRID_SIZE];
+    candidateMask unitFree[GRID_UNITS];
+    long blanks, tight, open;
+    int clues = 0, total = 0, singles = 0, dead = FALSE, hidden, distance;
+    cell i;
+
+    if ((!isValid(game)) || (!buildUnitMasks(game, unitFree)))
+        return FALSE;
+
+    // the counts are kept in locals, and the cells are looked at without
+    // branching on what they hold, which is random enough to make every
+    // branch a guess; a filled cell gets no candidates, so it drops out of
+    // the units below.
+    for (i = 0; i < GRID_SIZE; i++) {
+        int blank = (game[i] == BLANK);
+        candidateMask found = (unitFree[cellRows[i]]
+                & unitFree[GRID_LENGTH + cellColumns[i]]
+                & unitFree[(GRID_LENGTH * 2) + cellSubGrids[i]]
+                & -(candidateMask) blank);
+
+        candidates[i] = found;
+        singles += ((found != 0) & ((found & (found - 1)) == 0));
+        dead |= (blank & (found == 0));
+        clues += !blank;
+        total += countValues(found);
+    }
+
+    if (!dead) {
+        hidden = countHiddenSingles(unitFree, candidates);
+        if (hidden < 0)
+            dead = TRUE;
+        else
+            singles += hidden;
+    }
+
+    memset(estimate, 0, sizeof(*estimate));
+    estimate->clues = clues;
+    estimate->candidates = total;
+    estimate->singles = singles;
+    estimate->deadEnd = dead;
+
+    // the score is tight * open / (blanks * blanks), out of 100, where
+    // tight / blanks is from 0 (a single candidate each) to GRID_LENGTH - 1.
+    blanks = GRID_SIZE - clues;
+    if ((blanks) && (!dead)) {
+        tight = total - blanks;
+        open = (singles < blanks) ? blanks - singles : 0;
+        estimate->score = (int) ((100 * tight * open)
+                / ((GRID_LENGTH - 1) * blanks * blanks));
+    }
+
+    estimate->level = (estimate->score >= DIFFICULTY_HARD_SCORE)
+        ? DIFFICULTY_HARD : DIFFICULTY_EASY;
+
+    distance = abs(estimate->score - DIFFICULTY_HARD_SCORE);
+    if ((dead) || (distance > DIFFICULTY_MARGIN))
+        distance = DIFFICULTY_MARGIN;
+    estimate->confidence = 50 + (50 * distance) / DIFFICULTY_MARGIN;
+
+    return TRUE;
+}
+
+const char *difficultyName(int level) {
+    return (level == DIFFICULTY_HARD) ? "hard" : "easy";
+}
@@ -0,0 +1,361 @@
+#include <pthread.h>    // To keep a node pool per thread.
+#include <stdlib.h>     // To malloc() the node pool.
+#include "dlx.h"        // To access the Dancing Links declarations.
+#include "tables.h"     // To look up the groups of a cell.
+
+/*===========================================================================*/
+/*===== Dancing Links Structures. ===========================================*/
+/*===========================================================================*/
+
+#define ROOT 0  // The node linking the column headers, which are 1 onwards.
+
+// The exact cover matrix, as a pool of nodes linked by index. Each node
+// is in a circular list across its row and down its column; each column
+// has a header node, and the headers are in a circular list with ROOT.
+typedef struct {
+    int left[DLX_NODES];
+    int right[DLX_NODES];
+    int up[DLX_NODES];
+    int down[DLX_NODES];
+    int column[DLX_NODES];          // The header of a node's column.
+    int row[DLX_NODES];             // The matrix row a node is in.
+    int size[DLX_COLUMNS + 1];      // The rows left in a column, by header.
+    int rowStart[DLX_ROWS];         // The first node of each matrix row.
+
+    int givens[DLX_COLUMNS];        // The columns the givens covered, in
+    int givenCount;                 // order, to uncover after the search.
+    int chosen[GRID_SIZE];          // The rows chosen by the search so far.
+    int solution[GRID_SIZE];        // The rows of the first solution found.
+    int depth;                      // The number of rows chosen.
+    int solutionDepth;
+    long count;                     // Solutions found.
+    long limit;                     // Solutions to stop at, or 0.
+    searchStats stats;              // Nodes searched, and so on.
+    long nodeLimit;                 // Nodes to give up at, or 0.
+    long deadline;                  // searchMicros() to time out at, or 0.
+    int gaveUp;                     // If it stopped short, for any reason.
+    int timedOut;                   // If it stopped at the deadline, or on
+                                    // cancel.
+    const searchOptions *options;   // Their cancel tokens are checked with
+                                    // the clock, if not NULL.
+} dlxMatrix;
+
+// The key of each thread's matrix, which is built the first time the thread
+// searches, and freed when it exits.
+static pthread_key_t matrixKey;
+static pthread_once_t matrixKeyOnce = PTHREAD_ONCE_INIT;
+
+
+
+/*===========================================================================*/
+/*===== Static Helper Functions. ============================================*/
+/*===========================================================================*/
+
+/*======== Building the Matrix ===*/
+
+static void buildMatrix(dlxMatrix *m) {
+    int c, r, k, node;
+
+    // the headers, in a circle with ROOT, each an empty column.
+    for (c = 0; c <= DLX_COLUMNS; c++) {
+        m->left[c] = c - 1;
+        m->right[c] = c + 1;
+        m->up[c] = c;
+        m->down[c] = c;
+        m->column[c] = c;
+        m->size[c] = 0;
+    }
+    m->left[ROOT] = DLX_COLUMNS;
+    m->right[DLX_COLUMNS] = ROOT;
+
+    // a row of four nodes for each value in each cell.
+    node = DLX_COLUMNS + 1;
+    for (r = 0; r < DLX_ROWS; r++) {
+        cell i = r / GRID_LENGTH;
+        int d = r % GRID_LENGTH;
+        int headers[4];
+
+        headers[0] = 1 + i;
+        headers[1] = 1 + GRID_SIZE + (cellRows[i] * GRID_LENGTH) + d;
+        headers[2] = 1 + (GRID_SIZE * 2) + (cellColumns[i] * GRID_LENGTH) + d;
+        headers[3] = 1 + (GRID_SIZE * 3) + (cellSubGrids[i] * GRID_LENGTH) + d;
+
+        m->rowStart[r] = node;
+        for (k = 0; k < 4; k++) {
+            int n = node + k, h = headers[k];
+
+            // add the node to the bottom of its column.
+            m->column[n] = h;
+            m->row[n] = r;
+            m->up[n] = m->up[h];
+            m->down[n] = h;
+            m->down[m->up[h]] = n;
+            m->up[h] = n;
+            m->size[h]++;
+
+            m->left[n] = node + ((k + 3) % 4);
+            m->right[n] = node + ((k + 1) % 4);
+        }
+        node += 4;
+    }
+}
+
+
+/*======== Covering Columns ===*/
+
+static void cover(dlxMatrix *m, int c) {
+    int i, j;
+
+    // take the header out, then every row that crosses the column.
+    m->right[m->left[c]] = m->right[c];
+    m->left[m->right[c]] = m->left[c];
+
+    for (i = m->down[c]; i != c; i = m->down[i]) {
+        for (j = m->right[i]; j != i; j = m->right[j]) {
+            m->down[m->up[j]] = m->down[j];
+            m->up[m->down[j]] = m->up[j];
+            m->size[m->column[j]]--;
+        }
+    }
+}
+
+static void uncover(dlxMatrix *m, int c) {
+    int i, j;
+
+    // exactly the reverse of cover().
+    for (i = m->up[c]; i != c; i = m->up[i]) {
+        for (j = m->left[i]; j != i; j = m->left[j]) {
+            m->size[m->column[j]]++;
+            m->down[m->up[j]] = j;
+            m->up[m->down[j]] = j;
+        }
+    }
+
+    m->right[m->left[c]] = c;
+    m->left[m->right[c]] = c;
+}
+
+// Covers the columns of the rows of the givens of game, noting them in
+// m->givens.
+// Returns FALSE if two givens clash.
+static int selectGivens(dlxMatrix *m, sudokuGrid game) {
+    cell i;
+    int k;
+
+    m->givenCount = 0;
+    for (i = 0; i < GRID_SIZE; i++) {
+        int start;
+
+        if (game[i] == BLANK)
+            continue;
+
+        // a column already covered means the givens clash.
+        start = m->rowStart[(i * GRID_LENGTH) + VALUE_INDEX(game[i])];
+        for (k = 0; k < 4; k++) {
+            int c = m->column[start + k];
+            if (m->right[m->left[c]] != c)
+                return FALSE;
+        }
+
+        for (k = 0; k < 4; k++) {
+            m->givens[m->givenCount++] = m->column[start + k];
+            cover(m, m->column[start + k]);
+        }
+    }
+
+    return TRUE;
+}
+
+// Uncovers the columns selectGivens() covered, in the reverse order, which
+// leaves m as buildMatrix() built it for the next search.
+static void releaseGivens(dlxMatrix *m) {
+    while (m->givenCount > 0)
+        uncover(m, m->givens[--m->givenCount]);
+}
+
+
+/*======== Algorithm X ===*/
+
+static void search(dlxMatrix *m) {
+    int c, best, r, j;
+
+    // time out when out of time or called off by another thread, looking
+    // before the first node, and give up when out of nodes, before the
+    // node, as the backtracker does, so a limit of N searches N nodes.
+    if ((m->stats.nodes % STOP_CHECK_NODES == 0)
+            && (((m->deadline) && (searchMicros() >= m->deadline))
+                || ((m->options) && (searchCancelled(m->options))))) {
+        m->gaveUp = TRUE;
+        m->timedOut = TRUE;
+        return;
+    }
+    if ((m->nodeLimit) && (m->stats.nodes >= m->nodeLimit)) {
+        m->gaveUp = TRUE;
+        return;
+    }
+    m->stats.nodes++;
+
+    // every column covered is a solution.
+    if (m->right[ROOT] == ROOT) {
+        if (m->count++ == 0) {
+            memcpy(m->solution, m->chosen, m->depth * sizeof(int));
+            m->solutionDepth = m->depth;
+        }
+        return;
+    }
+
+    // branch on the column with the fewest rows.
+    best = m->right[ROOT];
+    for (c = m->right[best]; (c != ROOT) && (m->size[best] > 1);
+            c = m->right[c]) {
+        if (m->size[c] < m->size[best])
+            best = c;
+    }
+    if (m->size[best] == 0)
+        return;
+
+    cover(m, best);
+    for (r = m->down[best];
+            (r != best) && ((!m->limit) || (m->count < m->limit))
+                && (!m->gaveUp);
+            r = m->down[r]) {
+
+        // choose the row, covering its other columns.
+        m->chosen[m->depth++] = m->row[r];
+#ifdef SUDOKU_STATS
+        if (m->depth > m->stats.maxDepth)
+            m->stats.maxDepth = m->depth;
+#endif
+        for (j = m->right[r]; j != r; j = m->right[j])
+            cover(m, m->column[j]);
+
+        search(m);
+
+        for (j = m->left[r]; j != r; j = m->left[j])
+            uncover(m, m->column[j]);
+        m->depth--;
+#ifdef SUDOKU_STATS
+        m->stats.backtracks++;
+#endif
+    }
+    uncover(m, best);
+}
+
+static void makeMatrixKey(void) {
+    pthread_key_create(&matrixKey, free);
+}
+
+// Returns this thread's matrix, built the first time it is asked for, or
+// NULL if it couldn't be allocated. The search leaves every column
+// uncovered again, so it is only built once.
+static dlxMatrix *threadMatrix(void) {
+    dlxMatrix *m;
+
+    pthread_once(&matrixKeyOnce, makeMatrixKey);
+    m = pthread_getspecific(matrixKey);
+    if (!m) {
+        m = malloc(sizeof(*m));
+        if (!m)
+            return NULL;
+        buildMatrix(m);
+        pthread_setspecific(matrixKey, m);
+    }
+
+    return m;
+}
+
+// Runs the search for a grid on this thread's matrix, after covering its
+// givens. Once its solutions are read, releaseGivens() must be called.
+// Returns the matrix, for its solutions, or NULL with *status set to
+// SEARCH_NO_SOLUTION if the grid is invalid, or SEARCH_NO_MEMORY if there
+// is no matrix.
+static dlxMatrix *searchMatrix(sudokuGrid game, long limit,
+        const searchOptions *options, int *status) {
+    dlxMatrix *m;
+
+    if ((options) && (options->stats))
+        memset(options->stats, 0, sizeof(*options->stats));
+    *status = SEARCH_NO_SOLUTION;
+    if (!isValid(game))
+        return NULL;
+
+    m = threadMatrix();
+    if (!m) {
+        *status = SEARCH_NO_MEMORY;
+        return NULL;
+    }
+    m->depth = 0;
+    m->solutionDepth = 0;
+    m->count = 0;
+    m->limit = limit;
+    memset(&m->stats, 0, sizeof(m->stats));
+    m->nodeLimit = (options) ? options->nodeLimit : 0;
+    m->deadline = (options) ? options->deadline : 0;
+    if ((options) && (options->timeLimit) && ((!m->deadline)
+                || (searchMicros() + options->timeLimit < m->deadline)))
+        m->deadline = searchMicros() + options->timeLimit;
+    m->gaveUp = FALSE;
+    m->timedOut = FALSE;
+    m->options = options;
+
+    if (selectGivens(m, game))
+        search(m);
+    if ((options) && (options->stats))
+        *options->stats = m->stats;
+
+    return m;
+}
+
+
+
+/*===========================================================================*/
+/*===== Public Functions. ===================================================*/
+/*===========================================================================*/
+
+int dlxSolveGrid(sudokuGrid game, const searchOptions *options) {
+    dlxMatrix *m;
+    int status, i;
+
+    m = searchMatrix(game, 1, options, &status);
+    if (!m)
+        return status;
+
+    if (m->count > 0)
+        status = SEARCH_SOLVED;
+    else if (m->gaveUp)
+        status = (m->timedOut) ? SEARCH_TIMED_OUT : SEARCH_GAVE_UP;
+    else
+        status = SEARCH_NO_SOLUTION;
+
+    // fill in the value of each chosen row.
+    for (i = 0; (status == SEARCH_SOLVED) && (i < m->solutionDepth); i++) {
+        int r = m->solution[i];
+        game[r / GRID_LENGTH] = INDEX_VALUE(r % GRID_LENGTH);
+    }
+
+    releaseGivens(m);
+    return status;
+}
+
+int dlxCountGrid(sudokuGrid game, long limit, const searchOptions *options,
+        long *count) {
+    dlxMatrix *m;
+    int status;
+
+    *count = 0;
+    m = searchMatrix(game, limit, options, &status);
+    if (!m)
+        return status;
+
+    // reaching the limit stops the search, but isn't giving up.
+    *count = m->count;
+    if ((m->gaveUp) && ((!limit) || (m->count < limit)))
+        status = (m->timedOut) ? SEARCH_TIMED_OUT : SEARCH_GAVE_UP;
+    else if (m->count > 0)
+        status = SEARCH_SOLVED;
+    else
+        status = SEARCH_NO_SOLUTION;
+
+    releaseGivens(m);
+    return status;
+}
@@ -0,0 +1,41 @@
+/*=== Include Guard ===*/
+#ifndef DLX_H
+#define DLX_H
+
+
+/*=== Includes ===*/
+
+#include "solver.h"     // To use sudokuGrid and searchOptions.
+
+
+/*=== Defines ===*/
+
+// The exact cover matrix of a grid: a column for each cell, and for each
+// value in each row, column and sub-grid; a row for each value in each cell.
+#define DLX_COLUMNS (GRID_SIZE * 4)
+#define DLX_ROWS (GRID_SIZE * GRID_LENGTH)
+#define DLX_NODES (1 + DLX_COLUMNS + (DLX_ROWS * 4)) // Root, headers, cells.
+
+
+/*=== Function Declarations ===*/
+
+// Solves a valid grid in place with Dancing Links (Algorithm X), always
+// covering the column with the fewest rows left. The nodes come from a
+// pool per thread, built the first time the thread solves and left as it
+// was after each search, so later solves allocate and build nothing. Of
+// options, only the budgets, deadline, cancel and stats are used.
+// On failure the grid is left untouched.
+// Returns SEARCH_SOLVED, SEARCH_NO_SOLUTION, SEARCH_GAVE_UP,
+// SEARCH_TIMED_OUT or SEARCH_NO_MEMORY, if the matrix couldn't be built.
+int dlxSolveGrid(sudokuGrid game, const searchOptions *options);
+
+// Counts the solutions of a valid grid with Dancing Links, the same way as
+// countGrid(): stopping at limit (0 for no limit), and putting the number
+// found in *count. Of options, only the budgets, deadline, cancel and
+// stats are used.
+// Returns SEARCH_SOLVED, SEARCH_NO_SOLUTION, SEARCH_GAVE_UP,
+// SEARCH_TIMED_OUT or SEARCH_NO_MEMORY, if the matrix couldn't be built.
+int dlxCountGrid(sudokuGrid game, long limit, const searchOptions *options,
+        long *count);
+
+#endif
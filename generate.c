@@ -0,0 +1,214 @@
+#include <stdlib.h>     // To malloc() the search stack.
+#include "generate.h"   // To access generateOptions and the generate declarations.
+#include "solver.h"     // To solve the full grids and check the puzzles.
+#include "canon.h"      // To shuffle the full grids by a random symmetry.
+
+/*===========================================================================*/
+/*===== Static Helper Functions. ============================================*/
+/*===========================================================================*/
+
+// Returns a random number from 0 to count - 1.
+static int randomBelow(unsigned long long *seed, int count) {
+    return (int) (nextRandom(seed) % (unsigned long long) count);
+}
+
+// Puts the count items in a random order.
+static void shuffle(int *items, int count, unsigned long long *seed) {
+    int i, j, item;
+
+    for (i = count - 1; i > 0; i--) {
+        j = randomBelow(seed, i + 1);
+        item = items[i];
+        items[i] = items[j];
+        items[j] = item;
+    }
+}
+
+// Puts the numbers from 0 to count - 1 in a random order in items.
+static void randomOrder(int *items, int count, unsigned long long *seed) {
+    int i;
+
+    for (i = 0; i < count; i++)
+        items[i] = i;
+    shuffle(items, count, seed);
+}
+
+// Puts a random order of the rows (or columns) that keeps them in their
+// bands (or stacks) in lines.
+static void randomLines(unsigned char *lines, unsigned long long *seed) {
+    int bands[GRID_SUB_LENGTH], inner[GRID_SUB_LENGTH];
+    int b, k;
+
+    randomOrder(bands, GRID_SUB_LENGTH, seed);
+    for (b = 0; b < GRID_SUB_LENGTH; b++) {
+        randomOrder(inner, GRID_SUB_LENGTH, seed);
+        for (k = 0; k < GRID_SUB_LENGTH; k++)
+            lines[b * GRID_SUB_LENGTH + k] =
+                bands[b] * GRID_SUB_LENGTH + inner[k];
+    }
+}
+
+// Puts a random symmetry of the grid in transform.
+static void randomTransform(gridTransform *transform,
+        unsigned long long *seed) {
+    int labels[GRID_LENGTH];
+    int i;
+
+    transform->transposed = nextRandom(seed) & 1;
+    randomLines(transform->rows, seed);
+    randomLines(transform->columns, seed);
+
+    randomOrder(labels, GRID_LENGTH, seed);
+    transform->labels[0] = 0;
+    for (i = 0; i < GRID_LENGTH; i++)
+        transform->labels[i + 1] = labels[i] + 1;
+}
+
+// Returns TRUE if propagation alone fills in every BLANK cell of state.
+static int solvedByPropagation(const solverState *state) {
+    solverState trial = *state;
+
+    return (propagateState(&trial) && isFull(trial.game));
+}
+
+// Checks that the puzzle of state, in which removed has just been taken
+// out of targetCell, still has a single solution: the grid it had one for,
+// with removed in targetCell. So it searches for a solution with any other
+// value there, with search as its stack.
+// Returns TRUE if there is none, or FALSE if there is one or the search
+// ran out of nodes.
+static int keepsSingleSolution(searchStack *search, const solverState *state,
+        cell targetCell, value removed, long nodeLimit) {
+    solverState trial = *state;
+
+    trial.allowed[targetCell] &= ~(1u << VALUE_INDEX(removed));
+    initSearch(search, &trial, NULL);
+
+    return (runSearch(search, nodeLimit, 0) == SEARCH_NO_SOLUTION);
+}
+
+// Takes the clues out of a full grid in a random order, down to
+// options->clues, keeping each one that the puzzle needs: one whose
+// removal lets in another solution or, for GENERATE_EASY, one without
+// which propagation alone no longer solves it. The masks of the puzzle
+// are kept in step as clues go, rather than built again for each check.
+static void removeClues(searchStack *search, sudokuGrid puzzle,
+        const generateOptions *options, unsigned long long *seed) {
+    solverState state;
+    int order[GRID_SIZE];
+    int clues = GRID_SIZE, i, needed, ok;
+
+    ok = initState(&state, puzzle);
+    assert(ok);
+
+    randomOrder(order, GRID_SIZE, seed);
+    for (i = 0; (i < GRID_SIZE) && (clues > options->clues); i++) {
+        cell targetCell = order[i];
+        value removed = puzzle[targetCell];
+
+        ok = stateClearCell(&state, targetCell);
+        assert(ok);
+
+        if (options->difficulty == GENERATE_EASY)
+            needed = !solvedByPropagation(&state);
+        else
+            needed = !keepsSingleSolution(search, &state, targetCell,
+                    removed, options->nodeLimit);
+
+        if (needed) {
+            ok = stateSetCell(&state, targetCell, removed);
+            assert(ok);
+        } else {
+            clues--;
+        }
+    }
+
+    memcpy(puzzle, state.game, GRID_SIZE);
+}
+
+
+
+/*===========================================================================*/
+/*===== Public Functions. ===================================================*/
+/*===========================================================================*/
+
+void initGenerateOptions(generateOptions *options) {
+    options->clues = 0;
+    options->difficulty = GENERATE_ANY;
+    options->nodeLimit = GENERATE_NODE_LIMIT;
+}
+
+int generateSolution(sudokuGrid solution, unsigned long long *seed) {
+    searchOptions options;
+    gridTransform transform;
+    sudokuGrid full;
+    int values[GRID_LENGTH];
+    int s, k;
+
+    memset(full, BLANK, GRID_SIZE);
+    full[GRID_SIZE] = '\0';
+
+    // the sub-grids down the diagonal share no column, row or sub-grid,
+    // so each can take any order of the values.
+    for (s = 0; s < GRID_SUB_LENGTH; s++) {
+        randomOrder(values, GRID_LENGTH, seed);
+        for (k = 0; k < GRID_LENGTH; k++) {
+            int row = s * GRID_SUB_LENGTH + k / GRID_SUB_LENGTH;
+            int column = s * GRID_SUB_LENGTH + k % GRID_SUB_LENGTH;
+
+            full[row * GRID_LENGTH + column] = INDEX_VALUE(values[k]);
+        }
+    }
+
+    initOptions(&options);
+    options.nodeLimit = GENERATE_NODE_LIMIT;
+    if (solveGrid(full, &options) != SEARCH_SOLVED)
+        return FALSE;
+
+    // the solver fills in the rest in the same order every time, so
+    // shuffle the result by a random symmetry as well.
+    randomTransform(&transform, seed);
+    applyTransform(&transform, full, solution);
+
+    return TRUE;
+}
+
+int generatePuzzle(sudokuGrid puzzle, sudokuGrid solution,
+        const generateOptions *options, unsigned long long *seed) {
+    generateOptions defaults;
+    searchStack *search;
+    sudokuGrid full;
+    int tries, found = FALSE;
+
+    if (!options) {
+        initGenerateOptions(&defaults);
+        options = &defaults;
+    }
+
+    // one stack does for every check, since it is too big for the thread's.
+    search = malloc(sizeof(*search));
+    if (!search)
+        return FALSE;
+
+    for (tries = 0; (tries < GENERATE_TRIES) && (!found); tries++) {
+        if (!generateSolution(full, seed))
+            continue;
+
+        memcpy(puzzle, full, GRID_SIZE + 1);
+        removeClues(search, puzzle, options, seed);
+
+        found = (options->difficulty != GENERATE_HARD);
+        if (!found) {
+            solverState state;
+
+            found = ((initState(&state, puzzle))
+                    && (!solvedByPropagation(&state)));
+        }
+    }
+
+    if ((found) && (solution))
+        memcpy(solution, full, GRID_SIZE + 1);
+
+    free(search);
+    return found;
+}
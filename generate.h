@@ -0,0 +1,54 @@
+/*=== Include Guard ===*/
+#ifndef GENERATE_H
+#define GENERATE_H
+
+
+/*=== Includes ===*/
+
+#include "sudoku.h"     // To use sudokuGrid.
+
+
+/*=== Defines ===*/
+
+#define GENERATE_ANY 0      // Any puzzle with a single solution.
+#define GENERATE_EASY 1     // Solved by propagation alone, without a guess.
+#define GENERATE_HARD 2     // Not solved by propagation alone.
+
+#define GENERATE_TRIES 100              // Solutions tried for a puzzle.
+#define GENERATE_NODE_LIMIT 10000L      // Nodes a check searches, or 0.
+
+
+/*=== Typedefs ===*/
+
+// What sort of puzzle to generate.
+typedef struct {
+    int clues;          // Clues to stop removing at, or 0 to remove all
+                        // that can be while the solution stays single.
+    int difficulty;     // GENERATE_ANY, GENERATE_EASY or GENERATE_HARD.
+    long nodeLimit;     // Nodes each check that a removal keeps a single
+                        // solution may search, or 0 for no limit; a clue
+                        // whose check runs out is kept.
+} generateOptions;
+
+
+/*=== Function Declarations ===*/
+
+// Sets options to the defaults: as few clues as can be, of any
+// difficulty, and GENERATE_NODE_LIMIT nodes a check.
+void initGenerateOptions(generateOptions *options);
+
+// Makes a random full grid: its sub-grids down the diagonal are filled at
+// random, the rest solved, and the result shuffled by a random symmetry.
+// Returns TRUE, or FALSE if the solve gave up.
+int generateSolution(sudokuGrid solution, unsigned long long *seed);
+
+// Makes a random puzzle with a single solution, as options say, by
+// removing the clues of a random full grid in a random order, keeping
+// each one whose removal would let in a second solution. The solution is
+// put in solution, if it is not NULL.
+// Returns TRUE, or FALSE if no puzzle of the difficulty was found in
+// GENERATE_TRIES full grids, or the search couldn't be allocated.
+int generatePuzzle(sudokuGrid puzzle, sudokuGrid solution,
+        const generateOptions *options, unsigned long long *seed);
+
+#endif
@@ -0,0 +1,177 @@
+#include <stdio.h>          // To write the grids.
+#include <stdlib.h>         // To malloc() the blocks and parse the numbers.
+#include <string.h>         // To parse the difficulty.
+#include <time.h>           // To seed the generating.
+#include <unistd.h>         // To getopt() the command line options.
+#include "sudoku.h"         // To use sudokuGrid.
+#include "generate.h"       // To generate the puzzles.
+#include "pool.h"           // To generate them on more than one thread.
+#include "solver.h"         // To time the generating.
+
+#define GENERATE_BLOCK 64   // Grids each thread makes before they're written.
+
+// A block of puzzles being generated, the index'th of which has seed
+// seed ^ ((first + index) * GRID_SEED_STEP), so the same seed gives the
+// same puzzles on any number of threads.
+typedef struct {
+	const generateOptions *options;
+	unsigned long long seed;
+	long first;             // The number of puzzles before the block's.
+	sudokuGrid *puzzles;
+	int *found;             // Set where a puzzle was generated.
+} generateBlock;
+
+#define GRID_SEED_STEP 0xd1b54a32d192ed03ULL    // Odd, so every grid differs.
+
+// Prints how to run the program to stderr.
+static void printUsage(const char *name);
+
+// Generates the index'th puzzle of a block, as a poolTask.
+static void generateEntry(void *context, long index, int worker);
+
+
+/*=== Main: Generate Puzzles. ===*/
+int main(int argc, char *argv[]) {
+	generateOptions options;
+	generateBlock block;
+	threadPool *pool = NULL;
+	long count, size, made = 0, failed = 0, i;
+	long long start, elapsed;
+	int threads = 1;
+	int option;
+
+	initGenerateOptions(&options);
+	block.seed = (unsigned long long) time(NULL);
+
+	while ((option = getopt(argc, argv, "c:g:j:l:r:h")) != -1) {
+		switch (option) {
+			case 'c':
+				options.clues = atoi(optarg);
+				break;
+
+			case 'g':
+				block.seed = strtoull(optarg, NULL, 0);
+				break;
+
+			case 'j':
+				threads = atoi(optarg);
+				if ((threads < 1) || (threads > MAX_THREADS)) {
+					printUsage(argv[0]);
+					return 2;
+				}
+				break;
+
+			case 'l':
+				options.nodeLimit = atol(optarg);
+				break;
+
+			case 'r':
+				if (strcmp(optarg, "any") == 0) {
+					options.difficulty = GENERATE_ANY;
+				} else if (strcmp(optarg, "easy") == 0) {
+					options.difficulty = GENERATE_EASY;
+				} else if (strcmp(optarg, "hard") == 0) {
+					options.difficulty = GENERATE_HARD;
+				} else {
+					printUsage(argv[0]);
+					return 2;
+				}
+				break;
+
+			default:
+				printUsage(argv[0]);
+				return (option == 'h') ? 0 : 2;
+		}
+	}
+
+	if (optind != argc - 1) {
+		printUsage(argv[0]);
+		return 2;
+	}
+	count = atol(argv[optind]);
+
+	// one thread generates on this one, more start a pool.
+	if (threads > 1) {
+		pool = createPool(threads);
+		if (!pool) {
+			fprintf(stderr, "Could not start %d threads.\n", threads);
+			return 2;
+		}
+	}
+
+	size = GENERATE_BLOCK * threads;
+	block.options = &options;
+	block.puzzles = malloc(size * sizeof(*block.puzzles));
+	block.found = malloc(size * sizeof(*block.found));
+	if ((!block.puzzles) || (!block.found)) {
+		fprintf(stderr, "Could not allocate %ld grids.\n", size);
+		return 2;
+	}
+
+	// generate a block on every thread at once, then write it in order.
+	start = searchNanos();
+	for (block.first = 0; block.first < count; block.first += size) {
+		long tasks = (count - block.first < size)
+				? count - block.first : size;
+
+		if (pool) {
+			runPool(pool, tasks, generateEntry, &block);
+		} else {
+			for (i = 0; i < tasks; i++)
+				generateEntry(&block, i, 0);
+		}
+
+		for (i = 0; i < tasks; i++) {
+			if (block.found[i]) {
+				fputs(block.puzzles[i], stdout);
+				putc('\n', stdout);
+				made++;
+			} else {
+				failed++;
+			}
+		}
+	}
+	elapsed = searchNanos() - start;
+
+	fprintf(stderr, "%ld puzzles in %.3f s, %.0f puzzles/s, seed %llu",
+			made, elapsed / 1e9, (elapsed) ? made / (elapsed / 1e9) : 0.0,
+			block.seed);
+	if (failed)
+		fprintf(stderr, ", %ld given up on", failed);
+	putc('\n', stderr);
+
+	if (pool)
+		destroyPool(pool);
+	free(block.puzzles);
+	free(block.found);
+
+	return (failed) ? 1 : 0;
+}
+
+static void printUsage(const char *name) {
+	fprintf(stderr,
+			"Usage: %s [-c CLUES] [-g SEED] [-j THREADS] [-l NODES] [-r LEVEL] COUNT\n"
+			"Writes COUNT random puzzles with a single solution, one %d\n"
+			"character grid per line, then their number and rate to stderr.\n"
+			"  -c CLUES   stop taking clues out at CLUES (by default, take out\n"
+			"             every one the puzzle doesn't need)\n"
+			"  -g SEED    the seed, for the same puzzles again\n"
+			"  -j N       generate on N threads\n"
+			"  -l NODES   keep a clue if checking it takes more than NODES\n"
+			"             nodes (0 for no limit; %ld by default)\n"
+			"  -r LEVEL   any (the default); easy, solved without guessing; or\n"
+			"             hard, which needs guessing\n"
+			"Exits with 1 if a puzzle of LEVEL wasn't found in %d full grids.\n",
+			name, GRID_SIZE, GENERATE_NODE_LIMIT, GENERATE_TRIES);
+}
+
+static void generateEntry(void *context, long index, int worker) {
+	generateBlock *block = context;
+	unsigned long long seed = block->seed
+			^ ((unsigned long long) (block->first + index) * GRID_SEED_STEP);
+
+	(void) worker;
+	block->found[index] = generatePuzzle(block->puzzles[index], NULL,
+			block->options, &seed);
+}
+
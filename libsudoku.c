@@ -0,0 +1,145 @@
+#include "libsudoku.h"  // To access sudokuResult and the library declarations.
+#include "scan.h"       // To check the text as a grid.
+
+/*===========================================================================*/
+/*===== Static Helper Functions. ============================================*/
+/*===========================================================================*/
+
+// Checks text as a grid into result, copying it to result->solution if it
+// is one, without timing it.
+// Returns the status, as sudokuValidate() does.
+static int validateInto(const char *text, int length, sudokuResult *result) {
+    sudokuGrid empty;
+    solverState state;
+    gridScan scan;
+    cell i;
+
+    memset(&result->stats, 0, sizeof(result->stats));
+    memset(&result->estimate, 0, sizeof(result->estimate));
+    memset(result->solution, BLANK, GRID_SIZE);
+    result->solution[GRID_SIZE] = '\0';
+    result->count = 0;
+
+    if (!scanGrid(text, length, &scan)) {
+        result->length = scan.length;
+        result->badCell = scan.badCell;
+        return (result->status = SUDOKU_INVALID);
+    }
+
+    result->length = length;
+    result->badCell = -1;
+    memcpy(result->solution, text, GRID_SIZE);
+
+    // place the givens one at a time, as initState() does, to find which
+    // of them is the first to clash.
+    memset(empty, BLANK, GRID_SIZE);
+    empty[GRID_SIZE] = '\0';
+    if (!initState(&state, empty))
+        return (result->status = SUDOKU_INVALID);
+    for (i = 0; i < GRID_SIZE; i++) {
+        if ((text[i] != BLANK) && (!stateSetCell(&state, i, text[i]))) {
+            result->badCell = i;
+            return (result->status = SUDOKU_CLASH);
+        }
+    }
+
+    return (result->status = SUDOKU_VALID);
+}
+
+// Returns whether result is laid out as the library lays it out, setting
+// its status to SUDOKU_MISMATCH if not.
+static int layoutMatches(sudokuResult *result) {
+    if (result->layout == SUDOKU_LAYOUT)
+        return TRUE;
+
+    result->status = SUDOKU_MISMATCH;
+    return FALSE;
+}
+
+// Returns the status of a result whose search ended with status: the same,
+// but for SEARCH_NO_MEMORY, which is a library status of its own.
+static int searchResultStatus(int status) {
+    return (status == SEARCH_NO_MEMORY) ? SUDOKU_NO_MEMORY : status;
+}
+
+// Copies options, or the defaults, into search, with the stats going to
+// result.
+static void resultOptions(searchOptions *search, const searchOptions *options,
+        sudokuResult *result) {
+    if (options)
+        *search = *options;
+    else
+        initOptions(search);
+    search->stats = &result->stats;
+}
+
+
+
+/*===========================================================================*/
+/*===== Public Functions. ===================================================*/
+/*===========================================================================*/
+
+int sudokuValidate(const char *text, int length, sudokuResult *result) {
+    long start = searchMicros();
+
+    if (!layoutMatches(result))
+        return SUDOKU_MISMATCH;
+
+    validateInto(text, length, result);
+    result->micros = searchMicros() - start;
+
+    return result->status;
+}
+
+int sudokuEstimate(const char *text, int length, sudokuResult *result) {
+    long start = searchMicros();
+
+    if (!layoutMatches(result))
+        return SUDOKU_MISMATCH;
+
+    // the estimate only fails on grids that clash, which validating rules
+    // out, but a failure is still answered as one.
+    if ((validateInto(text, length, result) == SUDOKU_VALID)
+            && (!estimateDifficulty(result->solution, &result->estimate)))
+        result->status = SUDOKU_CLASH;
+    result->micros = searchMicros() - start;
+
+    return result->status;
+}
+
+int sudokuSolve(const char *text, int length, const searchOptions *options,
+        sudokuResult *result) {
+    long start = searchMicros();
+    searchOptions search;
+
+    if (!layoutMatches(result))
+        return SUDOKU_MISMATCH;
+
+    if (validateInto(text, length, result) == SUDOKU_VALID) {
+        resultOptions(&search, options, result);
+        result->status = searchResultStatus(solveGrid(result->solution,
+                &search));
+        result->count = (result->status == SEARCH_SOLVED);
+    }
+    result->micros = searchMicros() - start;
+
+    return result->status;
+}
+
+int sudokuCount(const char *text, int length, long limit,
+        const searchOptions *options, sudokuResult *result) {
+    long start = searchMicros();
+    searchOptions search;
+
+    if (!layoutMatches(result))
+        return SUDOKU_MISMATCH;
+
+    if (validateInto(text, length, result) == SUDOKU_VALID) {
+        resultOptions(&search, options, result);
+        result->status = searchResultStatus(countGrid(result->solution,
+                limit, &search, &result->count));
+    }
+    result->micros = searchMicros() - start;
+
+    return result->status;
+}
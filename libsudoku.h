@@ -0,0 +1,104 @@
+/*=== Include Guard ===*/
+#ifndef LIBSUDOKU_H
+#define LIBSUDOKU_H
+
+
+/*=== Includes ===*/
+
+#include "sudoku.h"     // To use sudokuGrid, cell and the grid size.
+#include "solver.h"     // To use searchOptions, searchStats and the statuses.
+#include "difficulty.h" // To use difficultyEstimate.
+
+
+/*=== Defines ===*/
+
+// Marks the calls the shared library exports. It is built with the rest of
+// the solver's functions hidden, so they don't clash with the host's own.
+#define SUDOKU_API __attribute__((visibility("default")))
+
+// The statuses of a result besides those of a search (SEARCH_SOLVED,
+// SEARCH_NO_SOLUTION, SEARCH_GAVE_UP and SEARCH_TIMED_OUT). A search's
+// SEARCH_NO_MEMORY is answered as SUDOKU_NO_MEMORY.
+#define SUDOKU_VALID 4      // The text is a grid whose givens don't clash.
+#define SUDOKU_INVALID 5    // The text isn't a grid: see length and badCell.
+#define SUDOKU_CLASH 6      // Two givens share a column, row or sub-grid, so
+                            // there is no solution: badCell is the later.
+#define SUDOKU_MISMATCH 7   // The result's layout isn't the library's, so
+                            // nothing else in it was written.
+#define SUDOKU_NO_MEMORY 8  // The search couldn't allocate what it needed.
+
+// Whether searchStats has the counters of SUDOKU_STATS, as the code using
+// the library was built.
+#ifdef SUDOKU_STATS
+#define SUDOKU_LAYOUT_STATS 1
+#else
+#define SUDOKU_LAYOUT_STATS 0
+#endif
+
+// How a sudokuResult is laid out, as the code using the library was built:
+// its size, the grid length and SUDOKU_LAYOUT_STATS. The size of both the
+// solution and the stats depend on how the code was built, so a caller
+// sets result->layout to this before each call, and a library built
+// otherwise answers SUDOKU_MISMATCH rather than write past the result.
+#define SUDOKU_LAYOUT ((((long) sizeof(sudokuResult)) << 8) \
+        | (GRID_LENGTH << 1) | SUDOKU_LAYOUT_STATS)
+
+
+/*=== Typedefs ===*/
+
+// What became of a grid given to the library.
+typedef struct {
+    long layout;            // SUDOKU_LAYOUT, set by the caller. It and
+                            // status come first, where every build has them.
+    int status;             // One of the statuses above.
+    sudokuGrid solution;    // The solution, if sudokuSolve() solved it;
+                            // otherwise the grid given, or all BLANK if the
+                            // text isn't a grid.
+    long count;             // The solutions found: by sudokuSolve(), 1 or 0.
+    int length;             // The length of the text given.
+    cell badCell;           // The first cell that isn't a value or BLANK, or
+                            // the later of two that clash, or -1.
+    searchStats stats;      // What the search did, however it ended.
+    difficultyEstimate estimate;    // How hard it looks, by sudokuEstimate().
+    long micros;            // How long it took, checking the text included.
+} sudokuResult;
+
+
+/*=== Function Declarations ===*/
+
+// The library is the solver without its console or its tests: none of
+// these functions read or write anything but their arguments, and they
+// keep no state between calls, so any number of threads can call them at
+// once. A grid is given as text, length characters of it (no '\0' is
+// needed), in the same format as readGrid(). Options are a searchOptions
+// set up with initOptions(), or NULL for the defaults; their stats are not
+// used, since the result has its own. Every call first checks that
+// result->layout is SUDOKU_LAYOUT, and if not returns SUDOKU_MISMATCH, put
+// in result->status, and writes nothing else.
+
+// Checks that text is a grid, and that its givens don't clash.
+// Returns SUDOKU_VALID, SUDOKU_INVALID, SUDOKU_CLASH or SUDOKU_MISMATCH,
+// also put in result->status.
+SUDOKU_API int sudokuValidate(const char *text, int length,
+        sudokuResult *result);
+
+// Estimates how hard the grid in text is, with estimateDifficulty(),
+// without solving it, into result->estimate.
+// Returns what sudokuValidate() does, also put in result->status.
+SUDOKU_API int sudokuEstimate(const char *text, int length,
+        sudokuResult *result);
+
+// Solves the grid in text, as options say.
+// Returns SEARCH_SOLVED, SEARCH_NO_SOLUTION, SEARCH_GAVE_UP,
+// SEARCH_TIMED_OUT, SUDOKU_INVALID, SUDOKU_CLASH, SUDOKU_MISMATCH or
+// SUDOKU_NO_MEMORY, also put in result->status.
+SUDOKU_API int sudokuSolve(const char *text, int length,
+        const searchOptions *options, sudokuResult *result);
+
+// Counts the solutions of the grid in text, as options say, stopping once
+// there are limit of them (0 for no limit), like countGrid().
+// Returns what sudokuSolve() does, also put in result->status.
+SUDOKU_API int sudokuCount(const char *text, int length, long limit,
+        const searchOptions *options, sudokuResult *result);
+
+#endif
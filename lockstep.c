@@ -0,0 +1,242 @@
+#include "lockstep.h"   // To access the lockstep declarations.
+#include "tables.h"     // To walk the cells of each unit.
+
+/*===========================================================================*/
+/*===== Lanes. ==============================================================*/
+/*===========================================================================*/
+
+// A cell's candidates in one grid, and the same cell in every grid of a
+// group, a lane each.
+#if GRID_LENGTH <= 16
+typedef unsigned short laneMask;
+#else
+typedef unsigned int laneMask;
+#endif
+typedef laneMask laneVector __attribute__((vector_size(LOCKSTEP_BYTES)));
+
+_Static_assert(LOCKSTEP_LANES * sizeof(laneMask) == LOCKSTEP_BYTES,
+        "LOCKSTEP_LANES must fill a vector");
+
+// The candidates of every cell of a group of grids.
+typedef struct {
+    laneVector cells[GRID_SIZE];
+    laneVector dead;    // All ones in the lanes found to have no solution.
+} laneGroup;
+
+/*===========================================================================*/
+/*===== Static Helper Functions. ============================================*/
+/*===========================================================================*/
+
+// All ones in the lanes of masks with exactly one value, and 0 in the
+// rest. Comparisons give lanes of all ones or 0, as signed ints of the same
+// size, which are cast back. Vectors are only passed to and from functions
+// by pointer, since without AVX their calling convention differs between
+// compilers.
+#define SINGLE_LANES(masks, zero) \
+    ((laneVector) (((masks) & ((masks) - 1)) == (zero)) \
+     & (laneVector) ((masks) != (zero)))
+
+// Returns TRUE if any lane of *lanes is not 0.
+static inline int anyLane(const laneVector *lanes) {
+    unsigned long long words[LOCKSTEP_BYTES / sizeof(unsigned long long)];
+    unsigned long long any = 0;
+    int w;
+
+    memcpy(words, lanes, sizeof(words));
+    for (w = 0; w < (int) (LOCKSTEP_BYTES / sizeof(unsigned long long)); w++)
+        any |= words[w];
+
+    return (any != 0);
+}
+
+// Takes the values placed in each unit out of the other cells of the unit,
+// in every lane: a naked single's value can't go in any of its peers.
+// Two cells of a unit placed with the same value, or a cell left with no
+// candidates, kill the lane.
+// Puts the lanes of any cells that changed in *changed.
+static void eliminateNakedSingles(laneGroup *group, laneVector *changed) {
+    const laneVector zero = {0};
+    laneVector placed[GRID_UNITS];
+    int unit, k;
+    cell i;
+
+    *changed = zero;
+    for (unit = 0; unit < GRID_UNITS; unit++) {
+        laneVector values = {0}, clashes = {0};
+
+        for (k = 0; k < GRID_LENGTH; k++) {
+            laneVector masks = group->cells[unitCells[unit][k]];
+            laneVector single = (masks & SINGLE_LANES(masks, zero));
+
+            clashes |= (values & single);
+            values |= single;
+        }
+
+        placed[unit] = values;
+        group->dead |= (laneVector) (clashes != zero);
+    }
+
+    for (i = 0; i < GRID_SIZE; i++) {
+        laneVector masks = group->cells[i];
+        laneVector single = SINGLE_LANES(masks, zero);
+        laneVector taken = (placed[cellRows[i]]
+                | placed[GRID_LENGTH + cellColumns[i]]
+                | placed[(GRID_LENGTH * 2) + cellSubGrids[i]]);
+        laneVector left = ((masks & single) | (masks & ~taken & ~single));
+
+        *changed |= (left ^ masks);
+        group->dead |= (laneVector) (left == zero);
+        group->cells[i] = left;
+    }
+}
+
+// Places each value that has a single cell left in a unit there, in every
+// lane. A value with no cell in a unit, or a cell that is the only one for
+// two values, kills the lane.
+// Puts the lanes of any cells that changed in *changed.
+static void placeHiddenSingles(laneGroup *group, laneVector *changed) {
+    const laneVector zero = {0};
+    const laneVector all = zero + (laneMask) ALL_CANDIDATES;
+    int unit, k;
+
+    *changed = zero;
+    for (unit = 0; unit < GRID_UNITS; unit++) {
+        laneVector once = {0}, twice = {0}, hidden;
+
+        for (k = 0; k < GRID_LENGTH; k++) {
+            laneVector masks = group->cells[unitCells[unit][k]];
+
+            twice |= (once & masks);
+            once |= masks;
+        }
+
+        group->dead |= (laneVector) (once != all);
+        hidden = (once & ~twice);
+
+        for (k = 0; k < GRID_LENGTH; k++) {
+            laneVector *masks = &group->cells[unitCells[unit][k]];
+            laneVector forced = (*masks & hidden);
+            laneVector found = (laneVector) (forced != zero);
+            laneVector left = ((forced & found) | (*masks & ~found));
+
+            group->dead |= (laneVector) ((forced & (forced - 1)) != zero);
+            *changed |= (left ^ *masks);
+            *masks = left;
+        }
+    }
+}
+
+// Loads up to LOCKSTEP_LANES grids into the lanes of group. Lanes without
+// a grid are left with every candidate everywhere, so nothing follows in
+// them.
+static void loadLanes(laneGroup *group, const sudokuGrid *games, int count) {
+    const laneVector zero = {0};
+    int lane;
+    cell i;
+
+    for (i = 0; i < GRID_SIZE; i++)
+        group->cells[i] = zero + (laneMask) ALL_CANDIDATES;
+    group->dead = zero;
+
+    for (lane = 0; lane < count; lane++) {
+        for (i = 0; i < GRID_SIZE; i++) {
+            if (games[lane][i] != BLANK)
+                group->cells[i][lane] =
+                    (laneMask) (1u << VALUE_INDEX(games[lane][i]));
+        }
+    }
+}
+
+// Writes the cells of a lane of group with a single candidate into game,
+// and the rest as BLANK.
+// Returns TRUE if every cell had a single candidate.
+static int storeLane(const laneGroup *group, int lane, sudokuGrid game) {
+    int full = TRUE;
+    cell i;
+
+    for (i = 0; i < GRID_SIZE; i++) {
+        laneMask masks = group->cells[i][lane];
+
+        if ((masks) && (!(masks & (masks - 1)))) {
+            game[i] = INDEX_VALUE(__builtin_ctz(masks));
+        } else {
+            game[i] = BLANK;
+            full = FALSE;
+        }
+    }
+    game[GRID_SIZE] = '\0';
+
+    return full;
+}
+
+// Solves a group of up to LOCKSTEP_LANES grids, as solveLockstep() does.
+static void solveGroup(sudokuGrid *games, int count,
+        const searchOptions *options, int *statuses, searchStats *stats) {
+    static const searchStats oneNode = {1};
+    laneGroup group;
+    searchOptions search;
+    laneVector changed, live;
+    int lane;
+
+    // propagate the cheap rule first, and the hidden singles only when it
+    // is stuck, as propagateState() does; the lanes carry on while any live
+    // one changes.
+    loadLanes(&group, games, count);
+    do {
+        eliminateNakedSingles(&group, &changed);
+        live = (changed & ~group.dead);
+        if (!anyLane(&live)) {
+            placeHiddenSingles(&group, &changed);
+            live = (changed & ~group.dead);
+        }
+    } while (anyLane(&live));
+
+    if (options)
+        search = *options;
+    else
+        initOptions(&search);
+    search.engine = ENGINE_BACKTRACK;
+
+    for (lane = 0; lane < count; lane++) {
+        sudokuGrid game;
+
+        if (stats)
+            stats[lane] = oneNode;
+
+        if (group.dead[lane]) {
+            statuses[lane] = SEARCH_NO_SOLUTION;
+            continue;
+        }
+
+        // the values propagated so far follow from the givens, so a
+        // solution of game is one of the grid.
+        if (storeLane(&group, lane, game)) {
+            statuses[lane] = SEARCH_SOLVED;
+        } else {
+            search.stats = (stats) ? &stats[lane] : NULL;
+            statuses[lane] = solveGrid(game, &search);
+        }
+
+        if (statuses[lane] == SEARCH_SOLVED)
+            memcpy(games[lane], game, GRID_SIZE);
+    }
+}
+
+
+
+/*===========================================================================*/
+/*===== Public Functions. ===================================================*/
+/*===========================================================================*/
+
+void solveLockstep(sudokuGrid *games, long count,
+        const searchOptions *options, int *statuses, searchStats *stats) {
+    long first;
+
+    for (first = 0; first < count; first += LOCKSTEP_LANES) {
+        int lanes = ((count - first) < LOCKSTEP_LANES)
+            ? (int) (count - first) : LOCKSTEP_LANES;
+
+        solveGroup(&games[first], lanes, options, &statuses[first],
+                (stats) ? &stats[first] : NULL);
+    }
+}
@@ -0,0 +1,43 @@
+/*=== Include Guard ===*/
+#ifndef LOCKSTEP_H
+#define LOCKSTEP_H
+
+
+/*=== Includes ===*/
+
+#include "solver.h"     // To use sudokuGrid, searchOptions and searchStats.
+
+
+/*=== Defines ===*/
+
+// The size of a vector of lanes: an AVX2 register where the compiler
+// targets AVX2, or else an SSE2 one, since GCC splits wider vectors into
+// pieces that cost more than they save.
+#ifdef __AVX2__
+#define LOCKSTEP_BYTES 32
+#else
+#define LOCKSTEP_BYTES 16
+#endif
+
+// The grids propagated at once: a lane each, of 16 bits for grids up to
+// 16x16, or 32 bits for 25x25 ones.
+#define LOCKSTEP_LANES (LOCKSTEP_BYTES / ((GRID_LENGTH <= 16) ? 2 : 4))
+
+
+/*=== Function Declarations ===*/
+
+// Solves count valid grids in place, LOCKSTEP_LANES at a time. The
+// candidates of every cell of a group of grids are held a lane each in
+// vectors, and naked and hidden singles are propagated for the whole group
+// at once, with the same instructions, until none of them change. A grid
+// that this solves, or shows has no solution, is done; the rest are handed
+// to the backtracking search as they stand, with options, one at a time.
+// The status of each grid is put in statuses, and if stats is not NULL,
+// what its search did in stats (a grid done in lockstep counts as one
+// node). A grid without a solution is left untouched.
+// The vectors use GCC's vector extensions, so the same code is AVX2 or SSE2
+// (or whatever the target has) as LOCKSTEP_BYTES says.
+void solveLockstep(sudokuGrid *games, long count,
+        const searchOptions *options, int *statuses, searchStats *stats);
+
+#endif
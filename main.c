@@ -1,20 +1,221 @@
 #include <stdio.h>          // To printf().
+#include <stdlib.h>         // To atoi() the option values.
+#include <unistd.h>         // To getopt() the command line options.
 #include "sudoku.h"         // To use sudoku functions.
+#include "console.h"        // To read and print a grid on the terminal.
+#include "solver.h"         // To search for a solution.
+#include "batch.h"          // To solve a file of grids.
+#include "output.h"         // To pick the format of a batch's results.
+#include "pack.h"           // To map a packed file of grids.
+#include "cache.h"          // To look up grids solved before.
+#include "server.h"         // To serve requests for solves.
+#include "parallel.h"       // To split a grid's search over threads.
+#include "lockstep.h"       // To say how many grids go in lockstep.
+#include "stats.h"          // To write what a search did.
+#include "difficulty.h"     // To estimate how hard a grid is.
 #include "testSudoku.h"     // To run unit tests.
+#include "testSolver.h"     // To run solver unit tests.
 
 
-// Prints grid if solveable, or 'no solution' if it has no solution,
-// Returns TRUE or FALSE based on success.
-int hasSolution(sudokuGrid game);
+// Prints how to run the program to stderr.
+static void printUsage(const char *name);
+
+// Solves every grid in the file at path ("-" for stdin) to stdout.
+// Returns 0 if all were solved, 1 if any had no solution, 2 if any were
+// invalid or the results couldn't be written, 3 if any ran out of nodes, 4
+// if any ran out of time.
+static int runBatch(const char *path, int threads, batchOptions *options);
+
+// Serves requests on the Unix domain socket at path, or on stdin and stdout
+// if path is "-", until stdin ends.
+// Returns 0 once stdin ends, or 2 if the socket or threads can't be set up.
+static int runServer(const char *path, int threads, serverOptions *options);
+
+// Solves a single grid in place, splitting its search over threads if
+// there is more than one.
+// Returns SEARCH_SOLVED, SEARCH_NO_SOLUTION, SEARCH_GAVE_UP,
+// SEARCH_TIMED_OUT or SEARCH_NO_MEMORY.
+static int solveSplit(sudokuGrid game, int threads,
+		const searchOptions *search);
+
+// Sets the branching options from a -c argument.
+// Returns TRUE or FALSE depending if the argument was known.
+static int parseBranching(const char *arg, searchOptions *search);
 
 /*=== Main: Solve a Grid. ===*/
-int main(int argc, const char *argv[]) {
+int main(int argc, char *argv[]) {
+
+	/*=========================*/
+	/*=== Parse the Options. ==*/
+	/*=========================*/
+
+	searchOptions search;
+	batchOptions batch = {0};
+	const char *batchPath = NULL;
+	const char *serverPath = NULL;
+	long cacheSize = 0;
+	int threads = 1;
+	int split = FALSE;
+	int option;
+
+	initOptions(&search);
+	batch.outputFormat = OUTPUT_UNKNOWN;
+	while ((option = getopt(argc, argv, "b:c:d:e:g:j:k:l:m:no:prs:t:u:h")) != -1) {
+		switch (option) {
+			case 'b':
+				batchPath = optarg;
+				break;
+
+			case 'd':
+				serverPath = optarg;
+				break;
+
+			case 'c':
+				if (!parseBranching(optarg, &search)) {
+					fprintf(stderr, "Unknown cell order '%s'.\n", optarg);
+					return 2;
+				}
+				break;
+
+			case 'k':
+				batch.counting = TRUE;
+				batch.countLimit = atol(optarg);
+				if (batch.countLimit < 0) {
+					fprintf(stderr, "-k takes a count to stop at, or 0.\n");
+					return 2;
+				}
+				break;
+
+			case 'l':
+				search.nodeLimit = atol(optarg);
+				if (search.nodeLimit < 1) {
+					fprintf(stderr, "-l takes a number of nodes.\n");
+					return 2;
+				}
+				break;
+
+			case 'g':
+				search.seed = strtoull(optarg, NULL, 0);
+				if (!search.seed) {
+					fprintf(stderr, "-g takes a seed other than 0.\n");
+					return 2;
+				}
+				break;
+
+			case 'u':
+				search.restartNodes = atol(optarg);
+				if (search.restartNodes < 1) {
+					fprintf(stderr, "-u takes a number of nodes.\n");
+					return 2;
+				}
+				break;
+
+			case 't':
+				search.timeLimit = atol(optarg) * 1000;
+				if (search.timeLimit < 1) {
+					fprintf(stderr, "-t takes a number of milliseconds.\n");
+					return 2;
+				}
+				break;
+
+			case 'm':
+				cacheSize = atol(optarg);
+				if (cacheSize < 1) {
+					fprintf(stderr, "-m takes a number of entries.\n");
+					return 2;
+				}
+				break;
+
+			case 'n':
+				search.propagate = FALSE;
+				break;
+
+			case 'o':
+				batch.outputFormat = parseOutputFormat(optarg);
+				if (batch.outputFormat == OUTPUT_UNKNOWN) {
+					fprintf(stderr, "Unknown output format '%s'.\n", optarg);
+					return 2;
+				}
+				break;
+
+			case 'p':
+				split = TRUE;
+				break;
+
+			case 'r':
+				batch.estimating = TRUE;
+				break;
+
+			case 's':
+				batch.statsFormat = parseStatsFormat(optarg);
+				batch.statsOut = stderr;
+				if (batch.statsFormat == STATS_NONE) {
+					fprintf(stderr, "Unknown stats format '%s'.\n", optarg);
+					return 2;
+				}
+				break;
+
+			case 'e':
+				if (strcmp(optarg, "backtrack") == 0) {
+					search.engine = ENGINE_BACKTRACK;
+				} else if (strcmp(optarg, "dlx") == 0) {
+					search.engine = ENGINE_DLX;
+				} else if (strcmp(optarg, "lockstep") == 0) {
+					search.engine = ENGINE_LOCKSTEP;
+				} else {
+					fprintf(stderr, "Unknown engine '%s'.\n", optarg);
+					return 2;
+				}
+				break;
+
+			case 'j':
+				threads = atoi(optarg);
+				if ((threads < 1) || (threads > MAX_THREADS)) {
+					fprintf(stderr, "-j takes 1 to %d threads.\n", MAX_THREADS);
+					return 2;
+				}
+				break;
+
+			default:
+				printUsage(argv[0]);
+				return (option == 'h') ? 0 : 2;
+		}
+	}
+
+	// restarts that all searched in the same order would be the same.
+	if ((search.restartNodes) && (!search.seed))
+		search.seed = 1;
+
+	// batch and server modes run no tests and ask for nothing.
+	if ((batchPath) || (serverPath)) {
+		if (cacheSize) {
+			batch.cache = createCache(cacheSize);
+			if (!batch.cache) {
+				fprintf(stderr, "Could not make a cache of %ld entries.\n",
+						cacheSize);
+				return 2;
+			}
+		}
+
+		if (serverPath) {
+			serverOptions server = {0};
+
+			server.search = search;
+			server.cache = batch.cache;
+			return runServer(serverPath, threads, &server);
+		}
+
+		batch.search = search;
+		return runBatch(batchPath, threads, &batch);
+	}
+
 
 	/*=======================*/
 	/*=== Run Unit Tests. ===*/
 	/*=======================*/
 
 	runTests(); // Unit tests.
+	runSolverTests();
 	printf("\n*******************************\n");
 
 
@@ -23,14 +224,21 @@ int main(int argc, const char *argv[]) {
 	/*=====================*/
 
 	sudokuGrid game = {0};
-	int ok, ret;
+	searchStats stats = {0};
+	const char *outcome;
+	int ok, ret, status;
+	long count, start, micros = 0;
+
+	// time the search, and keep its counts, to write them after or to say
+	// how far it got.
+	search.stats = &stats;
 
 	// read the grid into game.
-	if (argc == 1) {
+	if (optind == argc) {
 		ok = readGridFromConsole(game);
 
-	} else if (argc == 2) {
-		ok = readGrid(game, (value *)argv[1]);
+	} else if (optind == argc - 1) {
+		ok = readGrid(game, (value *)argv[optind]);
 
 	} else {
 		ok = FALSE;
@@ -44,10 +252,62 @@ int main(int argc, const char *argv[]) {
 		printf("+=== PLEASE TRY AGAIN. ===+\n");
 
 		ret = 2;
+	} else if (batch.estimating) {
+
+		// estimate how hard the grid is, without solving it.
+		difficultyEstimate estimate;
+
+		start = searchMicros();
+		status = (estimateDifficulty(game, &estimate))
+			? SEARCH_SOLVED : SEARCH_NO_SOLUTION;
+		micros = searchMicros() - start;
+
+		printf("\n"); // Vertical spacing.
+		if (status == SEARCH_SOLVED) {
+			printf("+=== The Grid Looks %s: Score %d, %d%% Confidence. ===+\n",
+					(estimate.level == DIFFICULTY_HARD) ? "Hard" : "Easy",
+					estimate.score, estimate.confidence);
+			ret = 0;
+		} else {
+			printf("+=== The Grid Has No Solution. ===+\n");
+			ret = 1;
+		}
+
+	} else if (batch.counting) {
+
+		// count the grid's solutions, up to the limit.
+		start = searchMicros();
+		status = countGrid(game, batch.countLimit, &search, &count);
+		micros = searchMicros() - start;
+
+		printf("\n"); // Vertical spacing.
+		if (status == SEARCH_NO_MEMORY) {
+			fprintf(stderr, "Could not allocate the search.\n");
+			ret = 2;
+		} else if (status == SEARCH_GAVE_UP) {
+			printf("+=== The Search Gave Up After %ld Solutions. ===+\n", count);
+			ret = 3;
+		} else if (status == SEARCH_TIMED_OUT) {
+			printf("+=== The Search Timed Out After %ld Solutions And %ld Nodes. ===+\n",
+					count, stats.nodes);
+			ret = 4;
+		} else {
+			printf("+=== The Grid Has %ld%s Solution%s. ===+\n", count,
+					((batch.countLimit) && (count >= batch.countLimit))
+						? " Or More" : "",
+					(count == 1) ? "" : "s");
+			ret = (count) ? 0 : 1;
+		}
+
 	} else {
 
 		// check if the grid has a solution.
-		if (hasSolution(game)) {
+		start = searchMicros();
+		status = (split) ? solveSplit(game, threads, &search)
+				: solveGrid(game, &search);
+		micros = searchMicros() - start;
+
+		if (status == SEARCH_SOLVED) {
 
 			// the grid has a solution.
 			printf("\n"); // Vertical spacing.
@@ -59,6 +319,30 @@ int main(int argc, const char *argv[]) {
 
 			ret = 0;
 
+		} else if (status == SEARCH_NO_MEMORY) {
+
+			// print that the search couldn't be set up.
+			fprintf(stderr, "Could not allocate the search.\n");
+
+			ret = 2;
+
+		} else if (status == SEARCH_GAVE_UP) {
+
+			// print that the search ran out of budget.
+			printf("\n"); // Vertical spacing.
+			printf("+=== The Search Gave Up Before Finding A Solution. ===+\n");
+
+			ret = 3;
+
+		} else if (status == SEARCH_TIMED_OUT) {
+
+			// print that the search ran out of time, and how far it got.
+			printf("\n"); // Vertical spacing.
+			printf("+=== The Search Timed Out After %ld Nodes. ===+\n",
+					stats.nodes);
+
+			ret = 4;
+
 		} else {
 
 			// print that the grid has no solution.
@@ -74,58 +358,264 @@ int main(int argc, const char *argv[]) {
 		}
 	}
 
+	// a grid that was read has a search to write about.
+	if ((ok) && (batch.statsFormat != STATS_NONE)) {
+		if (status == SEARCH_SOLVED)
+			outcome = "solved";
+		else if ((status == SEARCH_GAVE_UP) || (status == SEARCH_NO_MEMORY))
+			outcome = GAVE_UP_LINE;
+		else if (status == SEARCH_TIMED_OUT)
+			outcome = TIMED_OUT_LINE;
+		else
+			outcome = NO_SOLUTION_LINE;
+
+		fprintf(stderr, "\n");
+		writeStats(stderr, batch.statsFormat, 1, outcome, &stats, micros);
+	}
+
 	fprintf(stderr, "\nPress enter to quit.\n");
 	getchar();
 	return ret;
 }
 
 
-/*=== Function hasSolution(). ===*/
-int hasSolution(sudokuGrid game) {
-	// the grid has already been validated in the read.
+/*=== Function printUsage(). ===*/
+static void printUsage(const char *name) {
+	fprintf(stderr, "usage: %s [-e ENGINE] [-n] [-c ORDER] [-l NODES] [-t MILLIS] [-k LIMIT]\n", name);
+	fprintf(stderr, "           [-g SEED] [-u NODES] [-r] [-s FORMAT] [-p -j THREADS] [GRID]\n");
+	fprintf(stderr, "       %s -b FILE [-e ENGINE] [-n] [-c ORDER] [-l NODES] [-t MILLIS] [-k LIMIT]\n", name);
+	fprintf(stderr, "           [-g SEED] [-u NODES] [-r] [-s FORMAT] [-o FORMAT] [-j THREADS] [-m SIZE]\n");
+	fprintf(stderr, "       %s -d SOCKET [-e ENGINE] [-n] [-c ORDER] [-l NODES] [-t MILLIS]\n", name);
+	fprintf(stderr, "           [-g SEED] [-u NODES] [-j THREADS] [-m SIZE]\n\n");
+	fprintf(stderr, "  GRID     a grid of %d values, read from the console if not given.\n", GRID_SIZE);
+	fprintf(stderr, "  -c ORDER the cell to branch on: mrv (fewest candidates, the\n");
+	fprintf(stderr, "           default), mrv-last, mrv-degree (ties to the last cell,\n");
+	fprintf(stderr, "           or to the most blank neighbours), or first (blank cell).\n");
+	fprintf(stderr, "  -e ENGINE backtrack (the default), dlx for Dancing Links, or\n");
+	fprintf(stderr, "           lockstep to propagate a batch's grids %d at a time in\n",
+			LOCKSTEP_LANES);
+	fprintf(stderr, "           vector lanes, backtracking on those that need a guess.\n");
+	fprintf(stderr, "  -k LIMIT count the solutions instead, stopping at LIMIT (0 for\n");
+	fprintf(stderr, "           all); -k 2 checks a grid has a single solution.\n");
+	fprintf(stderr, "  -r       estimate how hard each grid is instead, from its candidates\n");
+	fprintf(stderr, "           before any search: a score from 0 to 100, a confidence\n");
+	fprintf(stderr, "           from 50 to 100%%, and easy or hard (a batch line each).\n");
+	fprintf(stderr, "  -l NODES give up on a grid after searching NODES nodes.\n");
+	fprintf(stderr, "  -t MILLIS time out on a grid after MILLIS milliseconds (a\n");
+	fprintf(stderr, "           server's requests from when they are read).\n");
+	fprintf(stderr, "  -m SIZE  in a batch or server, keep the solutions of up to SIZE\n");
+	fprintf(stderr, "           grids, by their canonical form, so a grid that is the\n");
+	fprintf(stderr, "           same up to symmetry and relabelling isn't solved again;\n");
+	fprintf(stderr, "           a batch writes its hits and misses to stderr at the end.\n");
+	fprintf(stderr, "  -n       don't propagate forced values, only backtrack.\n");
+	fprintf(stderr, "  -s FORMAT write what each search did to stderr, as json or csv,\n");
+	fprintf(stderr, "           and in a batch their totals and a latency histogram.\n");
+	fprintf(stderr, "  -b FILE  solve a grid per line of FILE (- for stdin), and write a\n");
+	fprintf(stderr, "           solution per line to stdout (or no solution, gave up,\n");
+	fprintf(stderr, "           or invalid, saying why on stderr). A packed FILE (see\n");
+	fprintf(stderr, "           sudokupack) is mapped, and its solutions written packed.\n");
+	fprintf(stderr, "  -o FORMAT write a batch's results as lines (the default for\n");
+	fprintf(stderr, "           text), json (an object per line, with what each search\n");
+	fprintf(stderr, "           did), packed (the default for a packed FILE; stdout\n");
+	fprintf(stderr, "           must be a file for text) or pretty (grids as printed\n");
+	fprintf(stderr, "           for a single GRID).\n");
+	fprintf(stderr, "  -d SOCKET serve requests on the Unix socket SOCKET (- for stdin\n");
+	fprintf(stderr, "           and stdout), a line each: solve GRID, count GRID [LIMIT],\n");
+	fprintf(stderr, "           hint GRID, stats or quit, answered in order a line each;\n");
+	fprintf(stderr, "           each connection's latencies go to stderr as it closes.\n");
+	fprintf(stderr, "  -j N     solve the batch, or the requests, on N threads.\n");
+	fprintf(stderr, "  -g SEED  try values, and break ties between cells, in a random\n");
+	fprintf(stderr, "           order from SEED (the same SEED searches the same way).\n");
+	fprintf(stderr, "  -u NODES restart a solve after NODES times the next Luby term\n");
+	fprintf(stderr, "           (1, 1, 2, 1, 1, 2, 4...) nodes, reseeded (from -g, or 1).\n");
+	fprintf(stderr, "  -p       split the search of a single GRID over the -j threads;\n");
+	fprintf(stderr, "           with -g, race a run per thread, seeded SEED ^ i * %#llx\n",
+			PORTFOLIO_SEED_STEP);
+	fprintf(stderr, "           for run i, and say on stderr which seed won.\n");
+}
+
 
-	int solved;
+/*=== Function runBatch(). ===*/
+static int runBatch(const char *path, int threads, batchOptions *options) {
+	batchTotals totals;
+	packedFile packed;
+	int packing = PACK_NOT_PACKED;
+	FILE *in = NULL;
 
-	// if it's already full, then it's already solved.
-	if (isFull(game)) {
-		solved = TRUE;
+	// open the input, which may be stdin, or a packed file to map.
+	if (strcmp(path, "-") == 0) {
+		in = stdin;
 	} else {
-		cell candidateCell;
-		value trialValue;
+		packing = openPacked(path, &packed);
+		if (packing == PACK_BAD) {
+			fprintf(stderr, "%s: not a packed file of %dx%d grids.\n",
+					path, GRID_LENGTH, GRID_LENGTH);
+			return 2;
+		} else if (packing == PACK_NOT_PACKED) {
+			in = fopen(path, "r");
+		}
 
-		solved = FALSE; // the grid is not solved yet.
-		candidateCell = getBlankCell(game); // Any blank cell.
-		assert(candidateCell != -1); // check there was a blank cell assigned.
-		trialValue = MIN_VALUE; // starting value, will incrument later.
+		if ((packing == PACK_ERROR) || ((packing != PACK_OK) && (!in))) {
+			perror(path);
+			return 2;
+		}
+	}
 
-		// check that the grid isn't solved, and that there are other possible
-		// answers to check with trialValue.
-		while ((!solved) && (trialValue <= MAX_VALUE)) {
+	// a packed file's solutions are packed, unless asked otherwise; text
+	// has to be counted before its packed count can be set.
+	if (options->outputFormat == OUTPUT_UNKNOWN)
+		options->outputFormat = (packing == PACK_OK) ? OUTPUT_PACKED : OUTPUT_LINES;
+	if ((options->outputFormat == OUTPUT_PACKED) && (packing != PACK_OK)
+			&& (!options->counting) && (!options->estimating)
+			&& (lseek(STDOUT_FILENO, 0, SEEK_CUR) < 0)) {
+		fprintf(stderr, "-o packed needs stdout to be a file, to set the "
+				"count of the grids once they are read.\n");
+		if (in != stdin)
+			fclose(in);
+		return 2;
+	}
 
-			// be sure the move is legal.
-			if (isLegal(game, candidateCell, trialValue)) {
-				int ok;
+	// one thread solves on this one, more start a pool.
+	if (threads > 1) {
+		options->pool = createPool(threads);
+		if (!options->pool) {
+			fprintf(stderr, "Could not start %d threads.\n", threads);
+			return 2;
+		}
+	}
 
-				// set the cell to the legal value and check if this is ok.
-				ok = setCell(game, candidateCell, trialValue);
-				assert(ok);
+	// say why lines aren't grids on stderr, out of the way of the results.
+	options->reportOut = stderr;
+	if (packing == PACK_OK)
+		solvePackedBatch(&packed, stdout, options, &totals);
+	else
+		solveBatch(in, stdout, options, &totals);
+
+	if (options->pool)
+		destroyPool(options->pool);
+	if (options->cache) {
+		cacheCounts counts;
+
+		getCacheCounts(options->cache, &counts);
+		fprintf(stderr, "cache: %ld hits, %ld misses, %ld evicted, "
+				"%ld of %ld entries used\n", counts.hits, counts.misses,
+				counts.evictions, counts.entries, counts.capacity);
+		destroyCache(options->cache);
+	}
+	if (packing == PACK_OK)
+		closePacked(&packed);
+	else if (in != stdin)
+		fclose(in);
+
+	// the exit status matches the one for a single grid.
+	if (totals.writeError) {
+		fprintf(stderr, "Could not write the results: %s.\n",
+				strerror(totals.writeError));
+		return 2;
+	} else if (totals.invalid)
+		return 2;
+	else if (totals.gaveUp)
+		return 3;
+	else if (totals.timedOut)
+		return 4;
+	else if (totals.unsolvable)
+		return 1;
+	else
+		return 0;
+}
 
-				// check if this new grid has a solution with recursivity.
-				// if this doesn't work out, clear the cell and backtrack.
-				if (hasSolution(game)) {
-					solved = TRUE; // the grid is solved.
 
-				} else {
-					ok = clearCell(game, candidateCell);
-					assert(ok);
-				}
-			}
+/*=== Function runServer(). ===*/
+static int runServer(const char *path, int threads, serverOptions *options) {
 
-			trialValue++; // move to the next trial value.
+	// one thread solves each connection's requests itself, more share a
+	// pool.
+	if (threads > 1) {
+		options->pool = createPool(threads);
+		if (!options->pool) {
+			fprintf(stderr, "Could not start %d threads.\n", threads);
+			return 2;
 		}
 	}
 
-	// returns based on if the grid has a solution or not.
-	return solved;
+	// the latencies go on stderr, out of the way of the answers.
+	options->logOut = stderr;
+	if (strcmp(path, "-") == 0) {
+		serveConnection(STDIN_FILENO, stdout, options, 1);
+	} else if (!serveSocket(path, options)) {
+		perror(path);
+		return 2;
+	}
+
+	if (options->pool)
+		destroyPool(options->pool);
+	if (options->cache)
+		destroyCache(options->cache);
+
+	return 0;
 }
 
+
+/*=== Function solveSplit(). ===*/
+static int solveSplit(sudokuGrid game, int threads,
+		const searchOptions *search) {
+	solverState state;
+	threadPool *pool;
+	int status;
+
+	// one thread has nothing to split over, and only the backtracking
+	// engine is split or raced.
+	if ((threads == 1) || (search->engine != ENGINE_BACKTRACK))
+		return solveGrid(game, search);
+
+	if (!initState(&state, game))
+		return SEARCH_NO_SOLUTION;
+
+	pool = createPool(threads);
+	if (!pool) {
+		fprintf(stderr, "Could not start %d threads.\n", threads);
+		return solveGrid(game, search);
+	}
+
+	// a seeded search is raced instead, and its winner can be run again.
+	if (search->seed) {
+		unsigned long long winner;
+
+		status = solvePortfolio(&state, pool, search, &winner);
+		if (SEARCH_OVER(status))
+			fprintf(stderr, "\nSeed %#llx answered first.\n", winner);
+	} else {
+		status = solveParallel(&state, pool, search);
+	}
+	if (status == SEARCH_SOLVED)
+		memcpy(game, state.game, GRID_SIZE);
+
+	destroyPool(pool);
+	return status;
+}
+
+
+/*=== Function parseBranching(). ===*/
+static int parseBranching(const char *arg, searchOptions *search) {
+	if (strcmp(arg, "first") == 0) {
+		search->branch = BRANCH_FIRST;
+		search->tieBreak = TIE_FIRST;
+
+	} else if (strcmp(arg, "mrv") == 0) {
+		search->branch = BRANCH_MRV;
+		search->tieBreak = TIE_FIRST;
+
+	} else if (strcmp(arg, "mrv-last") == 0) {
+		search->branch = BRANCH_MRV;
+		search->tieBreak = TIE_LAST;
+
+	} else if (strcmp(arg, "mrv-degree") == 0) {
+		search->branch = BRANCH_MRV;
+		search->tieBreak = TIE_DEGREE;
+
+	} else {
+		return FALSE;
+	}
+
+	return TRUE;
+}
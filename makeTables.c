@@ -0,0 +1,116 @@
+#include <stdio.h>          // To printf() the tables.
+
+// Writes tables.c to stdout: the lookup tables of tables.h, for every
+// sub-grid length from MIN_SUB_LENGTH to MAX_SUB_LENGTH, each under its own
+// #if, so that one file serves every build.
+
+#define MIN_SUB_LENGTH 2    // The smallest sub-grid length written out.
+#define MAX_SUB_LENGTH 5    // The largest.
+
+// Prints the tables for grids with sub-grids of subLength cells a side.
+static void printTables(int subLength);
+
+// Prints the start of a table, and sets *count to how many values are on
+// the current line of it.
+static void printTableStart(const char *declaration, int *count);
+
+// Prints a value of a table, wrapping the line after every 16.
+static void printTableValue(int value, int *count);
+
+/*=== Main: Write the Tables. ===*/
+int main(void) {
+	int subLength;
+
+	printf("/* Written by makeTables.c when building; don't edit. */\n");
+	printf("#include \"tables.h\"\n");
+
+	for (subLength = MIN_SUB_LENGTH; subLength <= MAX_SUB_LENGTH; subLength++) {
+		printf("\n%s GRID_SUB_LENGTH == %d\n",
+				(subLength == MIN_SUB_LENGTH) ? "#if" : "#elif", subLength);
+		printTables(subLength);
+	}
+	printf("\n#endif\n");
+
+	return 0;
+}
+
+static void printTables(int subLength) {
+	int length = subLength * subLength;
+	int size = length * length;
+	int i, j, k, count;
+
+	// the row, column and sub-grid of each cell.
+	printTableStart("const cell cellRows[GRID_SIZE]", &count);
+	for (i = 0; i < size; i++)
+		printTableValue(i / length, &count);
+	printf("\n};\n");
+
+	printTableStart("const cell cellColumns[GRID_SIZE]", &count);
+	for (i = 0; i < size; i++)
+		printTableValue(i % length, &count);
+	printf("\n};\n");
+
+	printTableStart("const cell cellSubGrids[GRID_SIZE]", &count);
+	for (i = 0; i < size; i++) {
+		printTableValue((((i / length) / subLength) * subLength)
+				+ ((i % length) / subLength), &count);
+	}
+	printf("\n};\n");
+
+	// every other cell in the same row, column or sub-grid, in order.
+	printTableStart("const cell cellPeers[GRID_SIZE][GRID_PEERS]", &count);
+	for (i = 0; i < size; i++) {
+		int row = i / length, column = i % length;
+
+		printf("\n    {");
+		count = 0;
+		for (j = 0; j < size; j++) {
+			int sameRow = ((j / length) == row);
+			int sameColumn = ((j % length) == column);
+			int sameSubGrid = (((j / length) / subLength == row / subLength)
+					&& ((j % length) / subLength == column / subLength));
+
+			if ((j != i) && (sameRow || sameColumn || sameSubGrid))
+				printTableValue(j, &count);
+		}
+		printf("},");
+	}
+	printf("\n};\n");
+
+	// the cells of each row, then each column, then each sub-grid.
+	printTableStart("const cell unitCells[GRID_UNITS][GRID_LENGTH]", &count);
+	for (i = 0; i < length * 3; i++) {
+		printf("\n    {");
+		count = 0;
+		for (k = 0; k < length; k++) {
+			int unit = i % length;
+
+			if (i < length) {
+				j = (unit * length) + k;
+			} else if (i < length * 2) {
+				j = (k * length) + unit;
+			} else {
+				j = ((unit / subLength) * subLength * length)
+						+ ((unit % subLength) * subLength)
+						+ ((k / subLength) * length) + (k % subLength);
+			}
+			printTableValue(j, &count);
+		}
+		printf("},");
+	}
+	printf("\n};\n");
+}
+
+static void printTableStart(const char *declaration, int *count) {
+	printf("\n%s = {", declaration);
+	*count = 16;
+}
+
+static void printTableValue(int value, int *count) {
+	if (*count == 16) {
+		printf("\n    ");
+		*count = 0;
+	}
+	printf("%d, ", value);
+	(*count)++;
+}
@@ -0,0 +1,165 @@
+#include <errno.h>      // To retry writes cut short by signals.
+#include <stdarg.h>     // To pass printOutput()'s arguments on.
+#include <stdlib.h>     // To malloc() the buffer.
+#include <unistd.h>     // To write() the buffer out.
+#include "output.h"     // To access outputWriter and the output declarations.
+
+// The most bytes of a line that isn't a grid: a count of solutions, an
+// estimate, or what became of the grid.
+#define LINE_EXTRA 32
+
+/*===========================================================================*/
+/*===== Static Helper Functions. ============================================*/
+/*===========================================================================*/
+
+// Writes length bytes to writer's fd, a part at a time if it takes them
+// that way, or notes why it couldn't. Nothing is written after a failure.
+static void writeAll(outputWriter *writer, const char *bytes, size_t length) {
+    ssize_t wrote;
+
+    while ((length > 0) && (!writer->error)) {
+        wrote = write(writer->fd, bytes, length);
+        if (wrote < 0) {
+            if (errno != EINTR)
+                writer->error = errno;
+            continue;
+        }
+
+        bytes += wrote;
+        length -= wrote;
+    }
+}
+
+
+
+/*===========================================================================*/
+/*===== Public Functions. ===================================================*/
+/*===========================================================================*/
+
+int parseOutputFormat(const char *name) {
+    if (strcmp(name, "lines") == 0)
+        return OUTPUT_LINES;
+    if (strcmp(name, "json") == 0)
+        return OUTPUT_JSON;
+    if (strcmp(name, "packed") == 0)
+        return OUTPUT_PACKED;
+    if (strcmp(name, "pretty") == 0)
+        return OUTPUT_PRETTY;
+
+    return OUTPUT_UNKNOWN;
+}
+
+size_t outputEntryBytes(int format) {
+    switch (format) {
+        case OUTPUT_JSON:
+            return GRID_SIZE + OUTPUT_ENTRY_EXTRA;
+
+        case OUTPUT_PRETTY:
+            return GRID_TEXT_SIZE + LINE_EXTRA;
+
+        default:
+            // a packed record is smaller than a line.
+            return GRID_SIZE + LINE_EXTRA;
+    }
+}
+
+int openWriter(outputWriter *writer, int fd, size_t size) {
+    // any entry must fit once the buffer is empty.
+    if (size < outputEntryBytes(OUTPUT_PRETTY))
+        size = outputEntryBytes(OUTPUT_PRETTY);
+    if (size < outputEntryBytes(OUTPUT_JSON))
+        size = outputEntryBytes(OUTPUT_JSON);
+
+    writer->fd = fd;
+    writer->used = 0;
+    writer->size = size;
+    writer->error = 0;
+    writer->buffer = malloc(size);
+
+    return (writer->buffer != NULL);
+}
+
+char *reserveOutput(outputWriter *writer, size_t length) {
+    assert(length <= writer->size);
+
+    if (writer->used + length > writer->size)
+        flushWriter(writer);
+
+    return (writer->buffer + writer->used);
+}
+
+void putOutput(outputWriter *writer, const void *bytes, size_t length) {
+    // a run too long for the buffer goes straight out, after the rest.
+    if (length > writer->size) {
+        flushWriter(writer);
+        writeAll(writer, bytes, length);
+        return;
+    }
+
+    memcpy(reserveOutput(writer, length), bytes, length);
+    writer->used += length;
+}
+
+void printOutput(outputWriter *writer, const char *format, ...) {
+    va_list arguments;
+    size_t room = writer->size - writer->used;
+    int length;
+
+    va_start(arguments, format);
+    length = vsnprintf(writer->buffer + writer->used, room, format, arguments);
+    va_end(arguments);
+
+    // print it again into the empty buffer if it didn't fit, cutting it
+    // short if it still doesn't.
+    if ((length >= 0) && ((size_t) length >= room)) {
+        flushWriter(writer);
+        room = writer->size;
+
+        va_start(arguments, format);
+        length = vsnprintf(writer->buffer, room, format, arguments);
+        va_end(arguments);
+        if ((size_t) length >= room)
+            length = room - 1;
+    }
+
+    if (length > 0)
+        writer->used += length;
+}
+
+int flushWriter(outputWriter *writer) {
+    writeAll(writer, writer->buffer, writer->used);
+    writer->used = 0;
+
+    return (!writer->error);
+}
+
+int rewriteOutput(outputWriter *writer, off_t offset, const void *bytes,
+        size_t length) {
+    const char *next = bytes;
+    ssize_t wrote;
+
+    flushWriter(writer);
+    while ((length > 0) && (!writer->error)) {
+        wrote = pwrite(writer->fd, next, length, offset);
+        if (wrote < 0) {
+            if (errno != EINTR)
+                writer->error = errno;
+            continue;
+        }
+
+        next += wrote;
+        offset += wrote;
+        length -= wrote;
+    }
+
+    return (!writer->error);
+}
+
+int closeWriter(outputWriter *writer) {
+    int ok = flushWriter(writer);
+
+    free(writer->buffer);
+    writer->buffer = NULL;
+
+    return ok;
+}
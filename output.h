@@ -0,0 +1,81 @@
+/*=== Include Guard ===*/
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+
+/*=== Includes ===*/
+
+#include <stddef.h>     // To use size_t.
+#include <sys/types.h>  // To use off_t.
+#include "sudoku.h"     // To use sudokuGrid and the grid size.
+
+
+/*=== Defines ===*/
+
+#define OUTPUT_LINES 0      // A line per grid: its values, or what became of it.
+#define OUTPUT_JSON 1       // A JSON object per line, with what the search did.
+#define OUTPUT_PACKED 2     // A packed file, as pack.h describes.
+#define OUTPUT_PRETTY 3     // Grids spaced out as printGrid() prints them.
+#define OUTPUT_UNKNOWN -1   // Not the name of a format.
+
+// The most bytes an entry of any format takes besides its grid: the JSON
+// members of a solve's outcome, count, estimate and stats.
+#define OUTPUT_ENTRY_EXTRA 512
+
+
+/*=== Typedefs ===*/
+
+// Output gathered into a buffer, to go out in one write() at a time.
+typedef struct {
+    int fd;         // Where the output goes.
+    char *buffer;
+    size_t used;    // The bytes in the buffer, not written yet.
+    size_t size;    // The bytes the buffer holds.
+    int error;      // The errno of the first write that failed, or 0. Once
+                    // one has, the output is dropped.
+} outputWriter;
+
+
+/*=== Function Declarations ===*/
+
+// Returns OUTPUT_LINES, OUTPUT_JSON, OUTPUT_PACKED or OUTPUT_PRETTY for a
+// format name ("lines", "json", "packed" or "pretty"), or OUTPUT_UNKNOWN.
+int parseOutputFormat(const char *name);
+
+// Returns the most bytes a grid's entry can take in format, so a buffer of
+// this many per grid holds a block of them.
+size_t outputEntryBytes(int format);
+
+// Sets up writer to write to fd, through a buffer of size bytes.
+// Returns FALSE if the buffer couldn't be allocated.
+int openWriter(outputWriter *writer, int fd, size_t size);
+
+// Adds length bytes to the output, writing out what is buffered first if
+// they don't fit.
+void putOutput(outputWriter *writer, const void *bytes, size_t length);
+
+// Adds a printf() style format to the output, as putOutput() does.
+void printOutput(outputWriter *writer, const char *format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+// Makes room for up to length bytes, writing out what is buffered first if
+// they don't fit, and returns where they go. Once they are there, they are
+// added with writer->used += their number.
+char *reserveOutput(outputWriter *writer, size_t length);
+
+// Writes out what is buffered, with a single write() unless the output
+// takes it a part at a time.
+// Returns FALSE if this or an earlier write failed.
+int flushWriter(outputWriter *writer);
+
+// Writes length bytes over the output at offset from the start of fd,
+// which must be a file that can seek, after flushing what is buffered.
+// Returns FALSE if this or an earlier write failed.
+int rewriteOutput(outputWriter *writer, off_t offset, const void *bytes,
+        size_t length);
+
+// Flushes writer and frees its buffer, leaving fd open.
+// Returns FALSE if a write failed, as flushWriter() does.
+int closeWriter(outputWriter *writer);
+
+#endif
@@ -0,0 +1,193 @@
+#include <fcntl.h>      // To open() files to map.
+#include <limits.h>     // To check record counts fit in a long.
+#include <sys/mman.h>   // To mmap() packed files.
+#include <sys/stat.h>   // To fstat() their size.
+#include <unistd.h>     // To close() them once mapped.
+#include "pack.h"       // To access packedFile and the pack declarations.
+
+#define PACK_MASK ((1u << PACK_BITS) - 1)  // The bits of a cell's code.
+
+/*===========================================================================*/
+/*===== Static Helper Functions. ============================================*/
+/*===========================================================================*/
+
+// Stores count little endian in the 8 bytes at bytes.
+static void putCount(unsigned char *bytes, long count) {
+    int i;
+
+    for (i = 0; i < 8; i++)
+        bytes[i] = (unsigned char) ((unsigned long long) count >> (8 * i));
+}
+
+// Returns the little endian count in the 8 bytes at bytes, or -1 if it
+// doesn't fit in a long.
+static long getCount(const unsigned char *bytes) {
+    unsigned long long count = 0;
+    int i;
+
+    for (i = 7; i >= 0; i--)
+        count = (count << 8) | bytes[i];
+
+    return (count > (unsigned long long) LONG_MAX) ? -1 : (long) count;
+}
+
+
+
+/*===========================================================================*/
+/*===== Public Functions. ===================================================*/
+/*===========================================================================*/
+
+/*======== Records ===*/
+
+void packDigits(const unsigned char *digits, unsigned char *record) {
+    unsigned int bits = 0;  // codes waiting to fill a byte.
+    int held = 0;           // how many bits of them there are.
+    cell i;
+
+    for (i = 0; i < GRID_SIZE; i++) {
+        bits |= (unsigned int) digits[i] << held;
+        held += PACK_BITS;
+
+        if (held >= 8) {
+            *record++ = (unsigned char) bits;
+            bits >>= 8;
+            held -= 8;
+        }
+    }
+
+    if (held > 0)
+        *record = (unsigned char) bits;
+}
+
+void packGrid(const sudokuGrid game, unsigned char *record) {
+    unsigned char digits[GRID_SIZE];
+    cell i;
+
+    for (i = 0; i < GRID_SIZE; i++)
+        digits[i] = (game[i] == BLANK) ? 0 : VALUE_INDEX(game[i]) + 1;
+
+    packDigits(digits, record);
+}
+
+cell unpackGrid(const unsigned char *record, sudokuGrid game) {
+    unsigned int bits = 0;  // codes read but not unpacked.
+    int held = 0;           // how many bits of them there are.
+    cell badCell = -1;
+    cell i;
+
+    for (i = 0; i < GRID_SIZE; i++) {
+        unsigned int code;
+
+        if (held < PACK_BITS) {
+            bits |= (unsigned int) *record++ << held;
+            held += 8;
+        }
+        code = bits & PACK_MASK;
+        bits >>= PACK_BITS;
+        held -= PACK_BITS;
+
+        if (code == 0) {
+            game[i] = BLANK;
+        } else if (code <= GRID_LENGTH) {
+            game[i] = INDEX_VALUE(code - 1);
+        } else {
+            game[i] = '?';
+            if (badCell == -1)
+                badCell = i;
+        }
+    }
+    game[GRID_SIZE] = '\0';
+
+    return badCell;
+}
+
+
+/*======== Files ===*/
+
+int openPacked(const char *path, packedFile *file) {
+    unsigned char header[PACK_HEADER];
+    struct stat status;
+    void *data;
+    long count;
+    int fd;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return PACK_ERROR;
+
+    if (fstat(fd, &status) < 0) {
+        close(fd);
+        return PACK_ERROR;
+    }
+
+    // too short to be packed, or mapped, like an empty text file.
+    if ((status.st_size < PACK_HEADER) || (!S_ISREG(status.st_mode))) {
+        close(fd);
+        return PACK_NOT_PACKED;
+    }
+
+    // the mapping stays after the file is closed.
+    data = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return PACK_ERROR;
+
+    if (memcmp(data, PACK_MAGIC, 4) != 0) {
+        munmap(data, status.st_size);
+        return PACK_NOT_PACKED;
+    }
+
+    // the header must be this build's, down to the record count.
+    makePackedHeader(header, 0);
+    count = getCount((const unsigned char *) data + 8);
+    if ((memcmp(data, header, 8) != 0) || (count < 0)
+            || ((status.st_size - PACK_HEADER) / PACK_RECORD != count)
+            || ((status.st_size - PACK_HEADER) % PACK_RECORD != 0)) {
+        munmap(data, status.st_size);
+        return PACK_BAD;
+    }
+
+    madvise(data, status.st_size, MADV_SEQUENTIAL);
+
+    file->data = data;
+    file->size = status.st_size;
+    file->count = count;
+    return PACK_OK;
+}
+
+void closePacked(packedFile *file) {
+    munmap((void *) file->data, file->size);
+    file->data = NULL;
+}
+
+const unsigned char *packedRecord(const packedFile *file, long i) {
+    return (file->data + PACK_HEADER + (i * PACK_RECORD));
+}
+
+void makePackedHeader(unsigned char *header, long count) {
+    memcpy(header, PACK_MAGIC, 4);
+    header[4] = PACK_VERSION;
+    header[5] = GRID_SUB_LENGTH;
+    header[6] = PACK_BITS;
+    header[7] = 0;
+    putCount(&header[8], count);
+}
+
+int writePackedHeader(FILE *out, long count) {
+    unsigned char header[PACK_HEADER];
+
+    makePackedHeader(header, count);
+    return (fwrite(header, PACK_HEADER, 1, out) == 1);
+}
+
+int setPackedCount(FILE *out, long count) {
+    unsigned char bytes[8];
+
+    putCount(bytes, count);
+    if (fseek(out, 8, SEEK_SET) != 0)
+        return FALSE;
+    if (fwrite(bytes, sizeof(bytes), 1, out) != 1)
+        return FALSE;
+
+    return (fseek(out, 0, SEEK_END) == 0);
+}
@@ -0,0 +1,94 @@
+/*=== Include Guard ===*/
+#ifndef PACK_H
+#define PACK_H
+
+
+/*=== Includes ===*/
+
+#include <stdio.h>      // To write FILE streams.
+#include <stddef.h>     // To use size_t.
+#include "sudoku.h"     // To use sudokuGrid and the grid size.
+
+
+/*=== Defines ===*/
+
+// A packed file is a PACK_HEADER byte header, then its records back to
+// back, each a grid of PACK_BITS bits per cell. The header is:
+//
+//   bytes 0-3   PACK_MAGIC, "SDKP".
+//   byte  4     PACK_VERSION.
+//   byte  5     GRID_SUB_LENGTH of the grids.
+//   byte  6     PACK_BITS.
+//   byte  7     0.
+//   bytes 8-15  the number of records, little endian.
+//
+// A cell holds its VALUE_INDEX() + 1, or 0 for BLANK, starting from the
+// lowest bits of the first byte; the bits left over in the last byte of a
+// record are 0. A 9x9 record is 41 bytes, half of a text line.
+#define PACK_MAGIC "SDKP"
+#define PACK_VERSION 1
+#define PACK_HEADER 16
+
+#if GRID_LENGTH < 16
+#define PACK_BITS 4     // Bits per cell, enough for GRID_LENGTH + 1 codes.
+#else
+#define PACK_BITS 5
+#endif
+
+#define PACK_RECORD (((GRID_SIZE * PACK_BITS) + 7) / 8) // Bytes per grid.
+
+#define PACK_OK 0           // The file is open and mapped.
+#define PACK_NOT_PACKED 1   // The file doesn't start with PACK_MAGIC.
+#define PACK_BAD 2          // The header is for other grids, or the file
+                            // is the wrong size for its record count.
+#define PACK_ERROR 3        // The file couldn't be read; see errno.
+
+
+/*=== Typedefs ===*/
+
+// A packed file, mapped into memory.
+typedef struct {
+    const unsigned char *data;  // The whole file.
+    size_t size;                // Its size in bytes.
+    long count;                 // The number of records in it.
+} packedFile;
+
+
+/*=== Function Declarations ===*/
+
+// Packs a grid of values and BLANKs into a record of PACK_RECORD bytes.
+void packGrid(const sudokuGrid game, unsigned char *record);
+
+// Packs a grid of digit codes (as in gridScan) into a record of
+// PACK_RECORD bytes.
+void packDigits(const unsigned char *digits, unsigned char *record);
+
+// Unpacks a record into game. A code that is not a value is unpacked as
+// '?', so that game is not valid.
+// Returns the first cell whose code is not a value or BLANK, or -1.
+cell unpackGrid(const unsigned char *record, sudokuGrid game);
+
+// Opens and maps the packed file at path, read only, without reading it.
+// Returns PACK_OK, with file filled in, or PACK_NOT_PACKED, PACK_BAD or
+// PACK_ERROR, with nothing left open.
+int openPacked(const char *path, packedFile *file);
+
+// Unmaps a packed file opened with openPacked().
+void closePacked(packedFile *file);
+
+// Returns record i of a packed file.
+const unsigned char *packedRecord(const packedFile *file, long i);
+
+// Fills in the PACK_HEADER bytes of header for a file of count records.
+void makePackedHeader(unsigned char *header, long count);
+
+// Writes the header of a packed file of count records to out.
+// Returns TRUE if it was written.
+int writePackedHeader(FILE *out, long count);
+
+// Sets the record count in the header at the start of out, which must be a
+// file that can seek, and leaves out at its end.
+// Returns TRUE if it was set.
+int setPackedCount(FILE *out, long count);
+
+#endif
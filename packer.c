@@ -0,0 +1,146 @@
+#include <stdio.h>          // To read and write the grids.
+#include <string.h>         // To trim the lines.
+#include <unistd.h>         // To getopt() the command line options.
+#include "sudoku.h"         // To use sudokuGrid.
+#include "scan.h"           // To check and parse the lines.
+#include "pack.h"           // To pack and unpack the grids.
+
+// Prints how to run the program to stderr.
+static void printUsage(const char *name);
+
+// Packs the grids of the text file at inPath ("-" for stdin), one per
+// line, into a packed file at outPath.
+// Returns 0, or 1 if a line isn't a grid, or 2 if a file can't be used.
+static int packFile(const char *inPath, const char *outPath);
+
+// Unpacks the packed file at inPath into a grid per line of out.
+// Returns 0, or 1 if a record isn't a grid, or 2 if the file can't be used.
+static int unpackFile(const char *inPath, FILE *out);
+
+/*=== Main: Convert Grids. ===*/
+int main(int argc, char *argv[]) {
+	int unpacking = FALSE;
+	int option;
+
+	while ((option = getopt(argc, argv, "uh")) != -1) {
+		switch (option) {
+			case 'u':
+				unpacking = TRUE;
+				break;
+
+			default:
+				printUsage(argv[0]);
+				return (option == 'h') ? 0 : 2;
+		}
+	}
+
+	if (unpacking) {
+		if (optind == argc - 1)
+			return unpackFile(argv[optind], stdout);
+
+	} else if (optind == argc - 2) {
+		return packFile(argv[optind], argv[optind + 1]);
+	}
+
+	printUsage(argv[0]);
+	return 2;
+}
+
+static void printUsage(const char *name) {
+	fprintf(stderr,
+			"Usage: %s IN OUT\n"
+			"       %s -u IN\n"
+			"Packs the grids of IN, one %d character grid per line (- for\n"
+			"stdin), into OUT, at %d bytes a grid after a %d byte header.\n"
+			"  -u  unpack the packed file IN into a grid per line on stdout\n"
+			"Exits with 1 if a line or record isn't a grid.\n",
+			name, name, GRID_SIZE, PACK_RECORD, PACK_HEADER);
+}
+
+static int packFile(const char *inPath, const char *outPath) {
+	char line[GRID_SIZE * 2];
+	unsigned char record[PACK_RECORD];
+	gridScan scan;
+	FILE *in, *out;
+	long count = 0, lineNumber = 0;
+	int status = 0;
+
+	in = (strcmp(inPath, "-") == 0) ? stdin : fopen(inPath, "r");
+	if (!in) {
+		perror(inPath);
+		return 2;
+	}
+
+	out = fopen(outPath, "wb");
+	if (!out) {
+		perror(outPath);
+		return 2;
+	}
+
+	// the count is set once all the records are written.
+	writePackedHeader(out, 0);
+
+	while (fgets(line, sizeof(line), in)) {
+		int length;
+
+		lineNumber++;
+		line[strcspn(line, "\r\n")] = '\0';
+		length = strlen(line);
+		if (length == 0)
+			continue;
+
+		if (!scanGrid(line, length, &scan)) {
+			fprintf(stderr, "%s: line %ld is not a grid.\n", inPath,
+					lineNumber);
+			status = 1;
+			break;
+		}
+
+		packDigits(scan.digits, record);
+		fwrite(record, PACK_RECORD, 1, out);
+		count++;
+	}
+
+	if ((!setPackedCount(out, count)) || (fclose(out) != 0)) {
+		perror(outPath);
+		status = 2;
+	}
+	if (in != stdin)
+		fclose(in);
+
+	return status;
+}
+
+static int unpackFile(const char *inPath, FILE *out) {
+	packedFile in;
+	sudokuGrid game;
+	long i;
+	int status = 0;
+
+	switch (openPacked(inPath, &in)) {
+		case PACK_OK:
+			break;
+
+		case PACK_ERROR:
+			perror(inPath);
+			return 2;
+
+		default:
+			fprintf(stderr, "%s: not a packed file of %dx%d grids.\n",
+					inPath, GRID_LENGTH, GRID_LENGTH);
+			return 2;
+	}
+
+	// a record that isn't a grid is still written, with '?' for bad cells.
+	for (i = 0; i < in.count; i++) {
+		if (unpackGrid(packedRecord(&in, i), game) != -1) {
+			fprintf(stderr, "%s: record %ld is not a grid.\n", inPath, i + 1);
+			status = 1;
+		}
+		fputs(game, out);
+		putc('\n', out);
+	}
+
+	closePacked(&in);
+	return status;
+}
@@ -0,0 +1,287 @@
+#include <stdlib.h>     // To malloc() the subtrees.
+#include <pthread.h>    // To add up the stats of the subtrees.
+#include "parallel.h"   // To access the parallel declarations.
+
+/*===========================================================================*/
+/*===== Parallel Search Structures. =========================================*/
+/*===========================================================================*/
+
+// What the subtree tasks share.
+typedef struct {
+    solverState *subtrees;      // The roots of the subtrees to search.
+    solverState *result;        // Where the first solution found goes.
+    atomic_int found;           // Set by the first task to find a solution.
+    atomic_int gaveUp;          // Set by any task that ran out of nodes.
+    atomic_int timedOut;        // Set by any task that ran out of time.
+    atomic_int noMemory;        // Set by any task that couldn't allocate.
+    pthread_mutex_t lock;       // Guards stats.
+    searchStats stats;          // What all of the tasks did.
+    searchOptions options;      // How to search, cancelled by found, or by
+                                // the caller's cancel.
+} parallelSearch;
+
+// What the runs of a portfolio share.
+typedef struct {
+    const solverState *start;   // The grid every run searches.
+    solverState *result;        // Where the winner's solution goes.
+    atomic_int answered;        // Set by the first run to end the search.
+    atomic_int gaveUp;          // Set by any run that ran out of nodes.
+    atomic_int timedOut;        // Set by any run that ran out of time.
+    atomic_int noMemory;        // Set by any run that couldn't allocate.
+    pthread_mutex_t lock;       // Guards stats and the winner.
+    searchStats stats;          // What all of the runs did.
+    int status;                 // The winner's status.
+    unsigned long long winner;  // The winner's seed.
+    searchOptions options;      // How to search, cancelled by answered, or
+                                // by the caller's cancel.
+} portfolioRace;
+
+
+
+/*===========================================================================*/
+/*===== Static Helper Functions. ============================================*/
+/*===========================================================================*/
+
+// Replaces the subtree at index with its children, one for each candidate
+// of its branching cell, appended at the end.
+// Returns TRUE if the subtree was already solved.
+static int splitSubtree(solverState *subtrees, long index, long *count,
+        const searchOptions *options) {
+    solverState *parent = &subtrees[index];
+    candidateMask candidates;
+    cell candidateCell;
+
+    candidateCell = chooseCell(parent, options);
+    if (candidateCell == -1)
+        return TRUE;
+
+    candidates = getCandidates(parent, candidateCell);
+    while (candidates) {
+        candidateMask bit = candidates & -candidates;
+        solverState *child = &subtrees[(*count)++];
+        int ok;
+
+        candidates &= ~bit;
+        *child = *parent;
+        ok = stateSetCell(child, candidateCell,
+                INDEX_VALUE(__builtin_ctz(bit)));
+        assert(ok);
+    }
+
+    return FALSE;
+}
+
+// A poolTask searching one subtree.
+static void searchSubtree(void *context, long index, int worker) {
+    parallelSearch *search = context;
+    solverState local = search->subtrees[index];
+
+    searchOptions options = search->options;
+    searchStats stats;
+    int status;
+
+    (void) worker;
+    options.stats = &stats;
+    status = searchState(&local, &options, NULL);
+
+    pthread_mutex_lock(&search->lock);
+    addStats(&search->stats, &stats);
+    pthread_mutex_unlock(&search->lock);
+    if (status == SEARCH_SOLVED) {
+        // only the first solution is kept; setting found cancels the rest.
+        if (!atomic_exchange(&search->found, TRUE))
+            *search->result = local;
+
+    } else if (status == SEARCH_GAVE_UP) {
+        atomic_store(&search->gaveUp, TRUE);
+    } else if (status == SEARCH_TIMED_OUT) {
+        atomic_store(&search->timedOut, TRUE);
+    } else if (status == SEARCH_NO_MEMORY) {
+        atomic_store(&search->noMemory, TRUE);
+    }
+}
+
+
+
+// A poolTask searching the index'th run of a portfolio.
+static void searchRun(void *context, long index, int worker) {
+    portfolioRace *race = context;
+    solverState local = *race->start;
+
+    searchOptions options = race->options;
+    searchStats stats;
+    int status;
+
+    (void) worker;
+    options.seed ^= (unsigned long long) index * PORTFOLIO_SEED_STEP;
+    options.stats = &stats;
+    status = searchState(&local, &options, NULL);
+
+    pthread_mutex_lock(&race->lock);
+    addStats(&race->stats, &stats);
+    pthread_mutex_unlock(&race->lock);
+    if (SEARCH_OVER(status)) {
+        // only the first answer is kept; setting answered cancels the rest.
+        if (!atomic_exchange(&race->answered, TRUE)) {
+            *race->result = local;
+            race->status = status;
+            race->winner = options.seed;
+        }
+
+    } else if (status == SEARCH_GAVE_UP) {
+        atomic_store(&race->gaveUp, TRUE);
+    } else if (status == SEARCH_NO_MEMORY) {
+        atomic_store(&race->noMemory, TRUE);
+    } else {
+        atomic_store(&race->timedOut, TRUE);
+    }
+}
+
+
+
+/*===========================================================================*/
+/*===== Public Functions. ===================================================*/
+/*===========================================================================*/
+
+int solveParallel(solverState *state, threadPool *pool,
+        const searchOptions *options) {
+    parallelSearch search;
+    solverState *subtrees;
+    searchStats stats = {0};
+    long target, capacity, first, count;
+    int solved = FALSE, gaveUp = FALSE, timedOut = FALSE, noMemory = FALSE;
+
+    // each split can add a child for every value, past the target.
+    target = (long) SPLIT_TASKS_PER_THREAD * poolThreads(pool);
+    capacity = target + GRID_LENGTH + 1;
+    subtrees = malloc(capacity * sizeof(*subtrees));
+    if (!subtrees) {
+        if ((options) && (options->stats))
+            *options->stats = stats;
+        return SEARCH_NO_MEMORY;
+    }
+
+    // split the shallowest subtree until there are enough of them, keeping
+    // the ones left in the array from first to count - 1.
+    subtrees[0] = *state;
+    first = 0;
+    count = 1;
+    while ((count - first < target) && (first < count) && (!solved)) {
+        solved = splitSubtree(subtrees, first, &count, options);
+        stats.nodes++;
+        if (solved)
+            *state = subtrees[first];
+        first++;
+
+        // keep the live subtrees at the front, to stay within capacity.
+        if (count + GRID_LENGTH > capacity) {
+            memmove(subtrees, &subtrees[first],
+                    (count - first) * sizeof(*subtrees));
+            count -= first;
+            first = 0;
+        }
+    }
+
+    // search the subtrees on the pool; if every subtree is a dead end
+    // the grid has no solution.
+    if ((!solved) && (first < count)) {
+        search.subtrees = &subtrees[first];
+        search.result = state;
+        atomic_init(&search.found, FALSE);
+        atomic_init(&search.gaveUp, FALSE);
+        atomic_init(&search.timedOut, FALSE);
+        atomic_init(&search.noMemory, FALSE);
+        pthread_mutex_init(&search.lock, NULL);
+        memset(&search.stats, 0, sizeof(search.stats));
+        initOptions(&search.options);
+        if (options)
+            search.options = *options;
+        search.options.cancel = &search.found;
+        search.options.parentCancel = (options) ? options->cancel : NULL;
+
+        // the time limit is for the whole search, not each subtree.
+        if ((search.options.timeLimit) && ((!search.options.deadline)
+                    || (searchMicros() + search.options.timeLimit
+                        < search.options.deadline)))
+            search.options.deadline = searchMicros()
+                + search.options.timeLimit;
+        search.options.timeLimit = 0;
+
+        runPool(pool, count - first, searchSubtree, &search);
+        solved = atomic_load(&search.found);
+        gaveUp = atomic_load(&search.gaveUp);
+        timedOut = atomic_load(&search.timedOut);
+        noMemory = atomic_load(&search.noMemory);
+        addStats(&stats, &search.stats);
+        pthread_mutex_destroy(&search.lock);
+    }
+
+    free(subtrees);
+    if ((options) && (options->stats))
+        *options->stats = stats;
+
+    if (solved)
+        return SEARCH_SOLVED;
+    else if (noMemory)
+        return SEARCH_NO_MEMORY;
+    else if (timedOut)
+        return SEARCH_TIMED_OUT;
+    else if (gaveUp)
+        return SEARCH_GAVE_UP;
+    else
+        return SEARCH_NO_SOLUTION;
+}
+
+int solvePortfolio(solverState *state, threadPool *pool,
+        const searchOptions *options, unsigned long long *winner) {
+    portfolioRace race;
+    solverState result;
+    int status;
+
+    race.start = state;
+    race.result = &result;
+    atomic_init(&race.answered, FALSE);
+    atomic_init(&race.gaveUp, FALSE);
+    atomic_init(&race.timedOut, FALSE);
+    atomic_init(&race.noMemory, FALSE);
+    pthread_mutex_init(&race.lock, NULL);
+    memset(&race.stats, 0, sizeof(race.stats));
+    race.status = SEARCH_GAVE_UP;
+    race.winner = 0;
+    initOptions(&race.options);
+    if (options)
+        race.options = *options;
+    race.options.cancel = &race.answered;
+    race.options.parentCancel = (options) ? options->cancel : NULL;
+    if (!race.options.seed)
+        race.options.seed = 1;
+
+    // the time limit is for the whole race, not each run.
+    if ((race.options.timeLimit) && ((!race.options.deadline)
+                || (searchMicros() + race.options.timeLimit
+                    < race.options.deadline)))
+        race.options.deadline = searchMicros() + race.options.timeLimit;
+    race.options.timeLimit = 0;
+
+    runPool(pool, poolThreads(pool), searchRun, &race);
+    pthread_mutex_destroy(&race.lock);
+
+    if ((options) && (options->stats))
+        *options->stats = race.stats;
+
+    if (atomic_load(&race.answered)) {
+        if (winner)
+            *winner = race.winner;
+        if (race.status == SEARCH_SOLVED)
+            *state = result;
+        status = race.status;
+    } else if (atomic_load(&race.noMemory)) {
+        status = SEARCH_NO_MEMORY;
+    } else if (atomic_load(&race.timedOut)) {
+        status = SEARCH_TIMED_OUT;
+    } else {
+        status = SEARCH_GAVE_UP;
+    }
+
+    return status;
+}
@@ -0,0 +1,51 @@
+/*=== Include Guard ===*/
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+
+/*=== Includes ===*/
+
+#include "solver.h"     // To use solverState.
+#include "pool.h"       // To search on a threadPool.
+
+
+/*=== Defines ===*/
+
+#define SPLIT_TASKS_PER_THREAD 8    // Subtrees made for each worker.
+#define PORTFOLIO_SEED_STEP 0xd1b54a32d192ed03ULL  // Odd, so every run of a
+                                                    // portfolio differs.
+
+
+/*=== Function Declarations ===*/
+
+// Solves a single grid on all the workers of a pool. The search tree is
+// split near its root, breadth first, until there are about
+// SPLIT_TASKS_PER_THREAD subtrees per worker; each subtree is then searched
+// as a task, and the first to find a solution calls the others off.
+// Cells are chosen as options say. Their node limit applies to each
+// subtree, and their time limit, deadline and cancel to the whole search.
+// Their stats get the nodes of every subtree.
+// On failure the state is left as it was passed.
+// Returns SEARCH_SOLVED; SEARCH_NO_MEMORY, if no solution was found but a
+// subtree couldn't be searched; SEARCH_TIMED_OUT, if one ran out of time;
+// SEARCH_GAVE_UP, if one ran out of nodes; or SEARCH_NO_SOLUTION.
+int solveParallel(solverState *state, threadPool *pool,
+        const searchOptions *options);
+
+// Races a portfolio of searches of a single grid on the workers of a
+// pool, one each, differing only in their seeds: run i searches with the
+// seed options->seed ^ (i * PORTFOLIO_SEED_STEP), so run 0 is the search
+// of options alone (with a seed of 0 taken as 1). The first run to find a
+// solution, or that there is none, calls the others off. Each run is as
+// searchState() does, with options' restarts and node limit, so it can be
+// repeated alone from its seed, which is put in *winner if it is not NULL.
+// Their time limit, deadline and cancel are for the whole race. Their
+// stats get the nodes of every run.
+// On failure the state is left as it was passed.
+// Returns SEARCH_SOLVED or SEARCH_NO_SOLUTION, from the winner; or
+// SEARCH_NO_MEMORY, if a run couldn't allocate; or SEARCH_TIMED_OUT, if
+// one ran out of time; or SEARCH_GAVE_UP.
+int solvePortfolio(solverState *state, threadPool *pool,
+        const searchOptions *options, unsigned long long *winner);
+
+#endif
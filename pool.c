@@ -0,0 +1,231 @@
+#include <pthread.h>    // To run the workers on threads.
+#include <stdlib.h>     // To malloc() and free() the pool.
+#include "pool.h"       // To access poolTask and the pool declarations.
+#include "sudoku.h"     // To use TRUE and FALSE.
+
+/*===========================================================================*/
+/*===== Pool Structures. ====================================================*/
+/*===========================================================================*/
+
+// The tasks a worker has left: the indexes front to back - 1.
+typedef struct {
+    pthread_mutex_t lock;
+    long front;
+    long back;
+} taskDeque;
+
+// What a worker thread is told when it is started.
+typedef struct {
+    threadPool *pool;
+    int id;
+} workerInfo;
+
+struct threadPool {
+    int threads;
+    pthread_t *workers;
+    workerInfo *infos;
+    taskDeque *deques;          // One per worker.
+
+    pthread_mutex_t lock;       // Guards everything below.
+    pthread_cond_t start;       // Signalled when a job is posted, or on stop.
+    pthread_cond_t done;        // Signalled when the last worker goes idle.
+    long generation;            // The number of jobs posted.
+    int idle;                   // Workers with nothing left in this job.
+    int stopping;
+
+    poolTask task;              // The job being run.
+    void *context;
+};
+
+
+
+/*===========================================================================*/
+/*===== Static Helper Functions. ============================================*/
+/*===========================================================================*/
+
+/*======== Taking Tasks ===*/
+
+static int takeOwnTask(threadPool *pool, int id, long *index) {
+    taskDeque *own = &pool->deques[id];
+    int ok = FALSE;
+
+    pthread_mutex_lock(&own->lock);
+    if (own->front < own->back) {
+        *index = own->front++;
+        ok = TRUE;
+    }
+    pthread_mutex_unlock(&own->lock);
+
+    return ok;
+}
+
+static int stealTasks(threadPool *pool, int id) {
+    int i;
+
+    // look through the other workers, starting after this one.
+    for (i = 1; i < pool->threads; i++) {
+        taskDeque *victim = &pool->deques[(id + i) % pool->threads];
+        long front, back;
+
+        // take the back half of what the victim has left.
+        pthread_mutex_lock(&victim->lock);
+        back = victim->back;
+        front = back - ((victim->back - victim->front + 1) / 2);
+        victim->back = front;
+        pthread_mutex_unlock(&victim->lock);
+
+        if (front < back) {
+            taskDeque *own = &pool->deques[id];
+
+            pthread_mutex_lock(&own->lock);
+            own->front = front;
+            own->back = back;
+            pthread_mutex_unlock(&own->lock);
+
+            return TRUE;
+        }
+    }
+
+    // every deque is empty, so the job is all taken.
+    return FALSE;
+}
+
+
+/*======== Worker Thread ===*/
+
+static void *workerMain(void *arg) {
+    workerInfo *info = arg;
+    threadPool *pool = info->pool;
+    long seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        long index;
+
+        // wait for a job that hasn't been run yet.
+        while ((!pool->stopping) && (pool->generation == seen))
+            pthread_cond_wait(&pool->start, &pool->lock);
+        if (pool->stopping)
+            break;
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        // run the worker's own tasks, then steal until there are none.
+        do {
+            while (takeOwnTask(pool, info->id, &index))
+                pool->task(pool->context, index, info->id);
+        } while (stealTasks(pool, info->id));
+
+        // the last worker to go idle finishes the job.
+        pthread_mutex_lock(&pool->lock);
+        if (++pool->idle == pool->threads)
+            pthread_cond_signal(&pool->done);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+
+
+/*===========================================================================*/
+/*===== Public Functions. ===================================================*/
+/*===========================================================================*/
+
+threadPool *createPool(int threads) {
+    threadPool *pool;
+    int i;
+
+    if ((threads < 1) || (threads > MAX_THREADS))
+        return NULL;
+
+    pool = calloc(1, sizeof(*pool));
+    if (!pool)
+        return NULL;
+
+    pool->workers = calloc(threads, sizeof(*pool->workers));
+    pool->infos = calloc(threads, sizeof(*pool->infos));
+    pool->deques = calloc(threads, sizeof(*pool->deques));
+    if ((!pool->workers) || (!pool->infos) || (!pool->deques)) {
+        free(pool->workers);
+        free(pool->infos);
+        free(pool->deques);
+        free(pool);
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    pool->idle = threads;
+
+    // start the workers; if one fails, stop the ones already going.
+    for (i = 0; i < threads; i++) {
+        pthread_mutex_init(&pool->deques[i].lock, NULL);
+        pool->infos[i].pool = pool;
+        pool->infos[i].id = i;
+
+        if (pthread_create(&pool->workers[i], NULL, workerMain,
+                    &pool->infos[i]) != 0) {
+            pool->threads = i;
+            destroyPool(pool);
+            return NULL;
+        }
+    }
+    pool->threads = threads;
+
+    return pool;
+}
+
+int poolThreads(const threadPool *pool) {
+    return pool->threads;
+}
+
+void runPool(threadPool *pool, long tasks, poolTask task, void *context) {
+    int i;
+
+    if (tasks <= 0)
+        return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->context = context;
+
+    // deal the tasks out in contiguous shares, one per worker.
+    for (i = 0; i < pool->threads; i++) {
+        pool->deques[i].front = (tasks * i) / pool->threads;
+        pool->deques[i].back = (tasks * (i + 1)) / pool->threads;
+    }
+
+    // wake the workers, and wait for the last of them to go idle.
+    pool->idle = 0;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+    while (pool->idle < pool->threads)
+        pthread_cond_wait(&pool->done, &pool->lock);
+
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void destroyPool(threadPool *pool) {
+    int i;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = TRUE;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (i = 0; i < pool->threads; i++)
+        pthread_join(pool->workers[i], NULL);
+
+    for (i = 0; i < pool->threads; i++)
+        pthread_mutex_destroy(&pool->deques[i].lock);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->start);
+    pthread_cond_destroy(&pool->done);
+
+    free(pool->workers);
+    free(pool->infos);
+    free(pool->deques);
+    free(pool);
+}
@@ -0,0 +1,42 @@
+/*=== Include Guard ===*/
+#ifndef POOL_H
+#define POOL_H
+
+
+/*=== Defines ===*/
+
+#define MAX_THREADS 256     // The most workers a pool can have.
+
+
+/*=== Typedefs ===*/
+
+// A task run by a pool: index is which of the job's tasks it is, and worker
+// is which thread of the pool is running it (0 to threads - 1).
+typedef void (*poolTask)(void *context, long index, int worker);
+
+// A set of worker threads, each with its own deque of tasks, that steal
+// from each other when they run out. Defined in pool.c.
+typedef struct threadPool threadPool;
+
+
+/*=== Function Declarations ===*/
+
+// Starts a pool of threads workers, which wait for jobs.
+// Returns NULL if the threads could not be started.
+threadPool *createPool(int threads);
+
+// Returns the number of workers in a pool.
+int poolThreads(const threadPool *pool);
+
+// Runs task for every index from 0 to tasks - 1 on the pool, and returns
+// when all of them are done. The indexes are split evenly between the
+// workers' deques; a worker takes from the front of its own deque, and
+// when it is empty steals the back half of another's, so a few slow tasks
+// don't hold up the rest of a worker's share.
+// Only one job runs on a pool at a time.
+void runPool(threadPool *pool, long tasks, poolTask task, void *context);
+
+// Stops the workers of a pool and frees it.
+void destroyPool(threadPool *pool);
+
+#endif
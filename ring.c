@@ -0,0 +1,107 @@
+#include <errno.h>      // To retry waits cut short by signals.
+#include <sched.h>      // To yield while a slot is being let go of.
+#include <stdlib.h>     // To malloc() the slots.
+#include "ring.h"       // To access longRing and the ring declarations.
+#include "sudoku.h"     // To use TRUE and FALSE.
+
+/*===========================================================================*/
+/*===== Static Helper Functions. ============================================*/
+/*===========================================================================*/
+
+// Claims the slot at the end of the ring that is moved on by position,
+// once its turn is the position plus offset: 0 to push to it, or 1 to pop
+// from it.
+// Returns the claimed position.
+static long claimSlot(longRing *ring, atomic_long *position, long offset) {
+    long at = atomic_load_explicit(position, memory_order_relaxed);
+
+    for (;;) {
+        ringSlot *slot = &ring->slots[at & (ring->capacity - 1)];
+        long turn = atomic_load_explicit(&slot->turn, memory_order_acquire);
+
+        if (turn == at + offset) {
+            if (atomic_compare_exchange_weak_explicit(position, &at, at + 1,
+                        memory_order_relaxed, memory_order_relaxed))
+                return at;
+
+        } else if (turn < at + offset) {
+            // the semaphore said there is a slot, but the thread that had
+            // it a lap ago has yet to let it go; it is about to.
+            sched_yield();
+            at = atomic_load_explicit(position, memory_order_relaxed);
+
+        } else {
+            // another thread claimed it first.
+            at = atomic_load_explicit(position, memory_order_relaxed);
+        }
+    }
+}
+
+
+
+/*===========================================================================*/
+/*===== Public Functions. ===================================================*/
+/*===========================================================================*/
+
+void waitSemaphore(sem_t *semaphore) {
+    while ((sem_wait(semaphore) != 0) && (errno == EINTR))
+        ;
+}
+
+int initRing(longRing *ring, long capacity) {
+    long i;
+
+    ring->capacity = 1;
+    while (ring->capacity < capacity)
+        ring->capacity *= 2;
+
+    ring->slots = malloc(ring->capacity * sizeof(*ring->slots));
+    if (!ring->slots)
+        return FALSE;
+
+    for (i = 0; i < ring->capacity; i++)
+        atomic_init(&ring->slots[i].turn, i);
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    sem_init(&ring->values, 0, 0);
+    sem_init(&ring->spaces, 0, (unsigned int) ring->capacity);
+
+    return TRUE;
+}
+
+void pushRing(longRing *ring, long value) {
+    ringSlot *slot;
+    long at;
+
+    waitSemaphore(&ring->spaces);
+    at = claimSlot(ring, &ring->tail, 0);
+    slot = &ring->slots[at & (ring->capacity - 1)];
+
+    slot->value = value;
+    atomic_store_explicit(&slot->turn, at + 1, memory_order_release);
+    sem_post(&ring->values);
+}
+
+long popRing(longRing *ring) {
+    ringSlot *slot;
+    long at, value;
+
+    waitSemaphore(&ring->values);
+    at = claimSlot(ring, &ring->head, 1);
+    slot = &ring->slots[at & (ring->capacity - 1)];
+
+    // the slot's next turn is to be pushed to a lap on.
+    value = slot->value;
+    atomic_store_explicit(&slot->turn, at + ring->capacity,
+            memory_order_release);
+    sem_post(&ring->spaces);
+
+    return value;
+}
+
+void destroyRing(longRing *ring) {
+    sem_destroy(&ring->values);
+    sem_destroy(&ring->spaces);
+    free(ring->slots);
+    ring->slots = NULL;
+}
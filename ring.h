@@ -0,0 +1,55 @@
+/*=== Include Guard ===*/
+#ifndef RING_H
+#define RING_H
+
+
+/*=== Includes ===*/
+
+#include <semaphore.h>  // To sleep while a ring is empty or full.
+#include <stdatomic.h>  // To claim the slots without a lock.
+
+
+/*=== Typedefs ===*/
+
+// A slot of a ring, and the turn it is on: a value can go in the slot at
+// position pos once turn is pos, and be taken out once it is pos + 1.
+typedef struct {
+    atomic_long turn;
+    long value;
+} ringSlot;
+
+// A bounded queue of longs, for any number of threads to push to and pop
+// from. Threads claim slots by moving the head and tail on with compare
+// and swap, and no lock is taken; they only sleep, on the semaphores, while
+// the ring is empty or full.
+typedef struct {
+    ringSlot *slots;
+    long capacity;      // A power of two.
+    atomic_long head;   // The position of the next value to pop.
+    atomic_long tail;   // The position of the next value to push.
+    sem_t values;       // Values pushed and not yet popped.
+    sem_t spaces;       // Slots not holding a value.
+} longRing;
+
+
+/*=== Function Declarations ===*/
+
+// Waits on a semaphore until it can be taken, through any signals that
+// cut the wait short.
+void waitSemaphore(sem_t *semaphore);
+
+// Sets up an empty ring of at least capacity slots.
+// Returns FALSE if they couldn't be allocated.
+int initRing(longRing *ring, long capacity);
+
+// Pushes value onto the back of the ring, waiting for space if it is full.
+void pushRing(longRing *ring, long value);
+
+// Pops the value at the front of the ring, waiting for one if it is empty.
+// Returns the value.
+long popRing(longRing *ring);
+
+// Frees the slots of a ring that no thread is using.
+void destroyRing(longRing *ring);
+
+#endif
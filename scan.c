@@ -0,0 +1,222 @@
+#include <string.h> // To memset() the blank mask.
+#include "scan.h"   // To access gridScan and the scan declarations.
+
+#if defined(__AVX2__)
+#include <immintrin.h>  // To check and parse 32 chars at a time.
+#elif defined(__SSE2__)
+#include <emmintrin.h>  // To check and parse 16 chars at a time.
+#endif
+
+/*===========================================================================*/
+/*===== Value Ranges. =======================================================*/
+/*===========================================================================*/
+
+// The values are the digits from MIN_VALUE to LAST_DIGIT, then the letters
+// from 'A' to MAX_VALUE in grids larger than 9x9. Every char outside these
+// ranges, other than BLANK, is invalid; chars past 127 are negative, so
+// compare below every range.
+#if GRID_LENGTH <= 9
+#define LAST_DIGIT MAX_VALUE
+#else
+#define LAST_DIGIT '9'
+#endif
+
+// The gap from the digit after '9' to 'A', taken off letters' digit codes.
+#define LETTER_GAP ('A' - '9' - 1)
+
+
+
+/*===========================================================================*/
+/*===== Static Helper Functions. ============================================*/
+/*===========================================================================*/
+
+/*======== Scalar ===*/
+
+// Returns TRUE if c is a value or BLANK, without branching.
+static inline int isScanValue(value c) {
+    int ok = ((c >= MIN_VALUE) & (c <= LAST_DIGIT)) | (c == BLANK);
+
+#if GRID_LENGTH > 9
+    ok |= ((c >= 'A') & (c <= MAX_VALUE));
+#endif
+    return ok;
+}
+
+// Returns the digit code of a value or BLANK, without branching.
+static inline unsigned char digitOf(value c) {
+    int digit = c - (MIN_VALUE - 1);
+
+#if GRID_LENGTH > 9
+    digit -= (c >= 'A') * LETTER_GAP;
+#endif
+    return (unsigned char) (digit * (c != BLANK));
+}
+
+
+/*======== Vector ===*/
+
+#if defined(__AVX2__)
+
+#define SCAN_CHUNK 32   // Chars checked at a time.
+
+typedef __m256i scanVector;
+
+// Loads SCAN_CHUNK chars.
+static inline scanVector loadChunk(const value *text) {
+    return _mm256_loadu_si256((const __m256i *) text);
+}
+
+// Returns a bit per char of chunk, set if it is a value or BLANK.
+static inline unsigned int validBits(scanVector chunk) {
+    scanVector ok = _mm256_and_si256(
+            _mm256_cmpgt_epi8(chunk, _mm256_set1_epi8(MIN_VALUE - 1)),
+            _mm256_cmpgt_epi8(_mm256_set1_epi8(LAST_DIGIT + 1), chunk));
+
+#if GRID_LENGTH > 9
+    ok = _mm256_or_si256(ok, _mm256_and_si256(
+            _mm256_cmpgt_epi8(chunk, _mm256_set1_epi8('A' - 1)),
+            _mm256_cmpgt_epi8(_mm256_set1_epi8(MAX_VALUE + 1), chunk)));
+#endif
+    ok = _mm256_or_si256(ok,
+            _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(BLANK)));
+
+    return (unsigned int) _mm256_movemask_epi8(ok);
+}
+
+// Stores the digit codes of a chunk of valid chars.
+// Returns a bit per char of chunk, set if it is BLANK.
+static inline unsigned int parseChunk(scanVector chunk, unsigned char *digits) {
+    scanVector blank = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(BLANK));
+    scanVector digit = _mm256_sub_epi8(chunk,
+            _mm256_set1_epi8(MIN_VALUE - 1));
+
+#if GRID_LENGTH > 9
+    digit = _mm256_sub_epi8(digit, _mm256_and_si256(
+            _mm256_cmpgt_epi8(chunk, _mm256_set1_epi8('A' - 1)),
+            _mm256_set1_epi8(LETTER_GAP)));
+#endif
+    _mm256_storeu_si256((__m256i *) digits, _mm256_andnot_si256(blank, digit));
+
+    return (unsigned int) _mm256_movemask_epi8(blank);
+}
+
+#elif defined(__SSE2__)
+
+#define SCAN_CHUNK 16   // Chars checked at a time.
+
+typedef __m128i scanVector;
+
+// Loads SCAN_CHUNK chars.
+static inline scanVector loadChunk(const value *text) {
+    return _mm_loadu_si128((const __m128i *) text);
+}
+
+// Returns a bit per char of chunk, set if it is a value or BLANK.
+static inline unsigned int validBits(scanVector chunk) {
+    scanVector ok = _mm_and_si128(
+            _mm_cmpgt_epi8(chunk, _mm_set1_epi8(MIN_VALUE - 1)),
+            _mm_cmplt_epi8(chunk, _mm_set1_epi8(LAST_DIGIT + 1)));
+
+#if GRID_LENGTH > 9
+    ok = _mm_or_si128(ok, _mm_and_si128(
+            _mm_cmpgt_epi8(chunk, _mm_set1_epi8('A' - 1)),
+            _mm_cmplt_epi8(chunk, _mm_set1_epi8(MAX_VALUE + 1))));
+#endif
+    ok = _mm_or_si128(ok, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(BLANK)));
+
+    return (unsigned int) _mm_movemask_epi8(ok);
+}
+
+// Stores the digit codes of a chunk of valid chars.
+// Returns a bit per char of chunk, set if it is BLANK.
+static inline unsigned int parseChunk(scanVector chunk, unsigned char *digits) {
+    scanVector blank = _mm_cmpeq_epi8(chunk, _mm_set1_epi8(BLANK));
+    scanVector digit = _mm_sub_epi8(chunk, _mm_set1_epi8(MIN_VALUE - 1));
+
+#if GRID_LENGTH > 9
+    digit = _mm_sub_epi8(digit, _mm_and_si128(
+            _mm_cmpgt_epi8(chunk, _mm_set1_epi8('A' - 1)),
+            _mm_set1_epi8(LETTER_GAP)));
+#endif
+    _mm_storeu_si128((__m128i *) digits, _mm_andnot_si128(blank, digit));
+
+    return (unsigned int) _mm_movemask_epi8(blank);
+}
+
+#else
+
+#define SCAN_CHUNK 1    // Chars checked at a time, with no vectors.
+
+#endif
+
+// The bits of a chunk's mask that are chars of it.
+#define CHUNK_BITS ((unsigned int) ((1ull << SCAN_CHUNK) - 1))
+
+// The first cell past the last whole chunk, checked one at a time from.
+#if SCAN_CHUNK > 1
+#define SCAN_TAIL (GRID_SIZE - (GRID_SIZE % SCAN_CHUNK))
+#else
+#define SCAN_TAIL 0
+#endif
+
+
+
+/*===========================================================================*/
+/*===== Public Functions. ===================================================*/
+/*===========================================================================*/
+
+cell findBadCell(const value *text) {
+    cell i;
+
+#if SCAN_CHUNK > 1
+    // a chunk with any bad char stops the scan at its first.
+    for (i = 0; i < SCAN_TAIL; i += SCAN_CHUNK) {
+        unsigned int bad = ~validBits(loadChunk(&text[i])) & CHUNK_BITS;
+
+        if (bad)
+            return (i + __builtin_ctz(bad));
+    }
+#endif
+
+    // the rest one at a time.
+    for (i = SCAN_TAIL; i < GRID_SIZE; i++) {
+        if (!isScanValue(text[i]))
+            return i;
+    }
+
+    return -1;
+}
+
+int scanGrid(const value *text, int length, gridScan *scan) {
+    cell i;
+
+    scan->length = length;
+    scan->badCell = -1;
+
+    if (length != GRID_SIZE)
+        return FALSE;
+
+    scan->badCell = findBadCell(text);
+    if (scan->badCell != -1)
+        return FALSE;
+
+    memset(scan->blanks, 0, sizeof(scan->blanks));
+
+#if SCAN_CHUNK > 1
+    // chunks start on multiples of their size, so never straddle a word.
+    for (i = 0; i < SCAN_TAIL; i += SCAN_CHUNK) {
+        unsigned long long blank = parseChunk(loadChunk(&text[i]),
+                &scan->digits[i]);
+
+        scan->blanks[i / 64] |= (blank << (i % 64));
+    }
+#endif
+
+    for (i = SCAN_TAIL; i < GRID_SIZE; i++) {
+        scan->digits[i] = digitOf(text[i]);
+        scan->blanks[i / 64] |= ((unsigned long long) (text[i] == BLANK)
+                << (i % 64));
+    }
+
+    return TRUE;
+}
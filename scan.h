@@ -0,0 +1,44 @@
+/*=== Include Guard ===*/
+#ifndef SCAN_H
+#define SCAN_H
+
+
+/*=== Includes ===*/
+
+#include "sudoku.h"     // To use value, cell and the grid size.
+
+
+/*=== Defines ===*/
+
+#define SCAN_WORDS ((GRID_SIZE + 63) / 64)  // Words in a mask of the cells.
+
+
+/*=== Typedefs ===*/
+
+// A line of text checked as a grid, and parsed when it is one.
+typedef struct {
+    unsigned char digits[GRID_SIZE];        // Each cell's VALUE_INDEX() + 1,
+                                            // or 0 for BLANK.
+    unsigned long long blanks[SCAN_WORDS];  // Bit (i % 64) of word (i / 64)
+                                            // is set if cell i is BLANK.
+    int length;                             // The length of the line.
+    cell badCell;                           // The first cell that is not a
+                                            // value or BLANK, or -1.
+} gridScan;
+
+
+/*=== Function Declarations ===*/
+
+// Checks the first GRID_SIZE chars of text, which must all be readable, 16
+// or 32 at a time where SSE2 or AVX2 are built in, without a branch per
+// char.
+// Returns the first cell that is not a value or BLANK, or -1 if all are.
+cell findBadCell(const value *text);
+
+// Checks a line of length chars as a grid, and parses it into scan: the
+// digits and blanks are only filled in if the line is a grid.
+// Returns TRUE if the line is GRID_SIZE values or BLANKs; otherwise FALSE,
+// with scan->length and scan->badCell saying why.
+int scanGrid(const value *text, int length, gridScan *scan);
+
+#endif
@@ -0,0 +1,693 @@
+#include <errno.h>      // To retry reads cut short by signals.
+#include <pthread.h>    // To serve each connection on a thread.
+#include <signal.h>     // To ignore clients that hang up early.
+#include <stdlib.h>     // To malloc() the requests and parse the limits.
+#include <sys/socket.h> // To listen for connections.
+#include <sys/stat.h>   // To check what is at the socket's path.
+#include <sys/un.h>     // To name the socket.
+#include <unistd.h>     // To read() and close() the connections.
+#include "server.h"     // To access serverOptions and the server declarations.
+#include "scan.h"       // To check each request's grid.
+
+/*===========================================================================*/
+/*===== Requests. ===========================================================*/
+/*===========================================================================*/
+
+#define REQUEST_INVALID 0   // The line wasn't a request.
+#define REQUEST_SOLVE 1     // Solve the grid.
+#define REQUEST_COUNT 2     // Count the grid's solutions.
+#define REQUEST_HINT 3      // Give a cell of the grid's solution.
+#define REQUEST_STATS 4     // Give the connection's latencies.
+#define REQUEST_QUIT 5      // Close the connection.
+
+#define REQUEST_WHY 64      // The longest reason a request is invalid.
+
+// A request, and its answer once solved.
+typedef struct {
+    int kind;
+    sudokuGrid game;            // The grid, then its solution.
+    long limit;                 // The count to stop at, for REQUEST_COUNT.
+    int status;                 // How the search ended.
+    long count;                 // The solutions found, for REQUEST_COUNT.
+    cell hintCell;              // The cell to fill, for REQUEST_HINT.
+    searchStats stats;          // What the search did.
+    char why[REQUEST_WHY];      // Why it is REQUEST_INVALID.
+} serverRequest;
+
+// A block of requests being solved.
+typedef struct serverBlock {
+    serverRequest *requests;
+    const serverOptions *options;
+    long deadline;      // When the requests time out, or 0.
+
+    // the rest are guarded by the request queue's lock, while queued.
+    int count;          // The requests in the block.
+    int next;           // The next request for a worker to take.
+    int left;           // The requests not yet solved.
+    pthread_cond_t solved;  // Signalled when none are left.
+    struct serverBlock *behind; // The block queued after this one.
+} serverBlock;
+
+// The blocks of requests of every connection served on a pool, waiting
+// for its workers. A worker takes one request at a time, from the block at
+// the front, which then goes to the back if it has more, so connections
+// take turns and a slow request only holds up the worker solving it. The
+// lock is only held to take a request, or to say one is solved.
+typedef struct {
+    pthread_mutex_t lock;   // Guards everything below.
+    pthread_cond_t queued;  // Signalled when a block is queued, or on stop.
+    serverBlock *front;
+    serverBlock *back;
+    int stopping;           // Once set, no more blocks are queued.
+    int running;            // The requests taken by workers, not yet solved.
+    int users;              // The connections, or servers, using the queue.
+    threadPool *pool;       // The workers, running one job that takes from
+    pthread_t runner;       // the queue until it stops, on this thread.
+} requestQueue;
+
+// The lines read from a connection but not yet made into requests.
+typedef struct {
+    int fd;
+    char buffer[SERVER_BUFFER + 1];     // With room for a last newline.
+    int start;          // The first byte not yet used.
+    int end;            // The byte after the last one read.
+    int ended;          // If the connection has no more to read.
+    int skipping;       // If the rest of a line too long to keep is being
+                        // read past.
+} requestReader;
+
+// A connection being served on a thread of its own.
+typedef struct {
+    int fd;
+    long number;        // Which connection it is, from 1.
+    const serverOptions *options;
+} serverConnection;
+
+// Only one job runs on a pool at a time, so every connection served on it
+// shares one queue, started by the first and stopped by the last.
+static pthread_mutex_t queueLock = PTHREAD_MUTEX_INITIALIZER;
+static requestQueue *sharedQueue;
+
+/*===========================================================================*/
+/*===== Static Helper Functions. ============================================*/
+/*===========================================================================*/
+
+/*======== Reading Requests ===*/
+
+// Makes a request of line, the length characters of a line without its
+// newline.
+static void parseRequest(char *line, int length, serverRequest *request) {
+    char *word, *grid, *limit, *rest;
+    int gridLength;
+    cell badCell;
+
+    request->kind = REQUEST_INVALID;
+    request->limit = SERVER_COUNT_LIMIT;
+    request->why[0] = '\0';
+    line[length] = '\0';
+
+    word = strtok_r(line, " \t\r", &rest);
+    grid = strtok_r(NULL, " \t\r", &rest);
+    limit = strtok_r(NULL, " \t\r", &rest);
+
+    if (strcmp(word, "solve") == 0) {
+        request->kind = REQUEST_SOLVE;
+    } else if (strcmp(word, "count") == 0) {
+        request->kind = REQUEST_COUNT;
+    } else if (strcmp(word, "hint") == 0) {
+        request->kind = REQUEST_HINT;
+    } else if ((strcmp(word, "stats") == 0) && (!grid)) {
+        request->kind = REQUEST_STATS;
+        return;
+    } else if ((strcmp(word, "quit") == 0) && (!grid)) {
+        request->kind = REQUEST_QUIT;
+        return;
+    } else {
+        snprintf(request->why, REQUEST_WHY, "unknown request '%.16s'", word);
+        return;
+    }
+
+    // the rest take a grid, and only a count a limit after it.
+    if ((!grid) || ((limit) && (request->kind != REQUEST_COUNT))
+            || (strtok_r(NULL, " \t\r", &rest))) {
+        snprintf(request->why, REQUEST_WHY, "%s takes a grid%s", word,
+                (request->kind == REQUEST_COUNT) ? " and maybe a limit" : "");
+        request->kind = REQUEST_INVALID;
+        return;
+    }
+
+    if (limit) {
+        request->limit = strtol(limit, &rest, 10);
+        if ((*rest) || (request->limit < 0)) {
+            snprintf(request->why, REQUEST_WHY, "limit '%.16s' is not a count",
+                    limit);
+            request->kind = REQUEST_INVALID;
+            return;
+        }
+    }
+
+    // the grid is only checked here; the solver parses it as it places
+    // the givens.
+    gridLength = strlen(grid);
+    if (gridLength != GRID_SIZE) {
+        snprintf(request->why, REQUEST_WHY, "%d chars, not %d", gridLength,
+                GRID_SIZE);
+        request->kind = REQUEST_INVALID;
+        return;
+    }
+
+    badCell = findBadCell(grid);
+    if (badCell != -1) {
+        snprintf(request->why, REQUEST_WHY,
+                "cell %d is '%c', not a value or '%c'", badCell,
+                grid[badCell], BLANK);
+        request->kind = REQUEST_INVALID;
+        return;
+    }
+
+    memcpy(request->game, grid, GRID_SIZE);
+    request->game[GRID_SIZE] = '\0';
+}
+
+// Reads more of a connection into reader's buffer, first moving what is
+// left to its start. A line that fills the buffer is dropped, with a
+// request saying so put in *tooLong, and the rest of it read past.
+// Returns FALSE, with reader->ended set, once there is nothing more.
+static int fillReader(requestReader *reader, serverRequest *tooLong,
+        int *tooLongCount) {
+    ssize_t got;
+
+    memmove(reader->buffer, reader->buffer + reader->start,
+            reader->end - reader->start);
+    reader->end -= reader->start;
+    reader->start = 0;
+
+    if (reader->end == SERVER_BUFFER) {
+        if (!reader->skipping) {
+            tooLong->kind = REQUEST_INVALID;
+            snprintf(tooLong->why, REQUEST_WHY, "over %d chars",
+                    SERVER_BUFFER);
+            (*tooLongCount)++;
+        }
+        reader->skipping = TRUE;
+        reader->end = 0;
+    }
+
+    do {
+        got = read(reader->fd, reader->buffer + reader->end,
+                SERVER_BUFFER - reader->end);
+    } while ((got < 0) && (errno == EINTR));
+
+    if (got <= 0) {
+        reader->ended = TRUE;
+        return FALSE;
+    }
+
+    reader->end += got;
+    return TRUE;
+}
+
+// Reads the next block of requests from a connection: every whole line
+// already read, up to size of them, or if there are none, the lines of the
+// next read that has any. Empty lines are skipped, and a last line without
+// a newline is taken once the connection ends.
+// Returns the number of requests, or 0 once the connection has ended.
+static int readRequests(requestReader *reader, serverRequest *requests,
+        int size) {
+    int count = 0;
+
+    while (count < size) {
+        char *line = reader->buffer + reader->start;
+        char *newline = memchr(line, '\n', reader->end - reader->start);
+        int length;
+
+        if (!newline) {
+            // a block doesn't wait for more than the lines it has.
+            if ((count) || (reader->ended))
+                break;
+            // a last line without a newline is given one.
+            if ((!fillReader(reader, &requests[count], &count))
+                    && (reader->end > reader->start))
+                reader->buffer[reader->end++] = '\n';
+            continue;
+        }
+
+        length = newline - line;
+        reader->start += length + 1;
+
+        // the end of a line too long to keep is only passed over.
+        if (reader->skipping) {
+            reader->skipping = FALSE;
+            continue;
+        }
+        if (strspn(line, " \t\r") >= (size_t) length)
+            continue;
+
+        parseRequest(line, length, &requests[count++]);
+    }
+
+    return count;
+}
+
+
+/*======== Answering Requests ===*/
+
+// A poolTask solving one request of a block. It only touches its own
+// request.
+static void solveRequest(void *context, long index, int worker) {
+    serverBlock *block = context;
+    serverRequest *request = &block->requests[index];
+
+    const serverOptions *options = block->options;
+    searchOptions search = options->search;
+    solverState state;
+    sudokuGrid solution;
+
+    (void) worker;
+    memset(&request->stats, 0, sizeof(request->stats));
+    search.stats = &request->stats;
+    if (block->deadline) {
+        search.deadline = block->deadline;
+        search.timeLimit = 0;
+    }
+
+    switch (request->kind) {
+        case REQUEST_SOLVE:
+            if (options->cache)
+                request->status = solveCached(options->cache, request->game,
+                        &search);
+            else
+                request->status = solveGrid(request->game, &search);
+            break;
+
+        case REQUEST_COUNT:
+            request->status = countGrid(request->game, request->limit,
+                    &search, &request->count);
+            break;
+
+        case REQUEST_HINT:
+            strcpy(solution, request->game);
+            if (options->cache)
+                request->status = solveCached(options->cache, solution,
+                        &search);
+            else
+                request->status = solveGrid(solution, &search);
+
+            // the most constrained cell is the one to look at next.
+            request->hintCell = -1;
+            if ((request->status == SEARCH_SOLVED)
+                    && (initState(&state, request->game))) {
+                request->hintCell = chooseCell(&state, NULL);
+                if (request->hintCell != -1)
+                    request->game[request->hintCell] =
+                        solution[request->hintCell];
+            }
+            break;
+    }
+}
+
+/*======== The Request Queue ===*/
+
+// Puts block at the back of the queue, whose lock is held.
+static void queueBlock(requestQueue *queue, serverBlock *block) {
+    block->behind = NULL;
+    if (queue->back)
+        queue->back->behind = block;
+    else
+        queue->front = block;
+    queue->back = block;
+}
+
+// A poolTask run once by each worker, solving queued requests until the
+// queue stops and is empty.
+static void serveQueue(void *context, long index, int worker) {
+    requestQueue *queue = context;
+    serverBlock *block;
+    int i;
+
+    (void) index;
+    pthread_mutex_lock(&queue->lock);
+    for (;;) {
+        while ((!queue->front) && (!queue->stopping))
+            pthread_cond_wait(&queue->queued, &queue->lock);
+        if (!queue->front)
+            break;
+
+        // take the front block's next request, and let the next block
+        // have a turn.
+        block = queue->front;
+        i = block->next++;
+        queue->front = block->behind;
+        if (!queue->front)
+            queue->back = NULL;
+        if (block->next < block->count)
+            queueBlock(queue, block);
+        queue->running++;
+        pthread_mutex_unlock(&queue->lock);
+
+        solveRequest(block, i, worker);
+
+        pthread_mutex_lock(&queue->lock);
+        queue->running--;
+        if (--block->left == 0)
+            pthread_cond_signal(&block->solved);
+    }
+    pthread_mutex_unlock(&queue->lock);
+}
+
+// Runs the queue's job on its pool, until the queue stops.
+static void *runQueue(void *context) {
+    requestQueue *queue = context;
+
+    runPool(queue->pool, poolThreads(queue->pool), serveQueue, queue);
+    return NULL;
+}
+
+// Returns the queue of pool, starting it if nothing is using it yet, or
+// NULL if it couldn't be started. Every queue returned is let go of with
+// releaseQueue().
+static requestQueue *acquireQueue(threadPool *pool) {
+    requestQueue *queue;
+
+    pthread_mutex_lock(&queueLock);
+    queue = sharedQueue;
+    if (!queue) {
+        queue = calloc(1, sizeof(*queue));
+        if (queue) {
+            pthread_mutex_init(&queue->lock, NULL);
+            pthread_cond_init(&queue->queued, NULL);
+            queue->pool = pool;
+            if (pthread_create(&queue->runner, NULL, runQueue, queue) != 0) {
+                pthread_mutex_destroy(&queue->lock);
+                pthread_cond_destroy(&queue->queued);
+                free(queue);
+                queue = NULL;
+            }
+        }
+        sharedQueue = queue;
+    }
+
+    // a queue runs on one pool; another has to wait for it to stop.
+    assert((!queue) || (queue->pool == pool));
+    if (queue)
+        queue->users++;
+    pthread_mutex_unlock(&queueLock);
+
+    return queue;
+}
+
+// Lets go of a queue from acquireQueue(), stopping it once the last user
+// does, after its workers have solved what is queued.
+static void releaseQueue(requestQueue *queue) {
+    pthread_mutex_lock(&queueLock);
+    if (--queue->users > 0) {
+        pthread_mutex_unlock(&queueLock);
+        return;
+    }
+    sharedQueue = NULL;
+    pthread_mutex_unlock(&queueLock);
+
+    pthread_mutex_lock(&queue->lock);
+    queue->stopping = TRUE;
+    pthread_cond_broadcast(&queue->queued);
+    pthread_mutex_unlock(&queue->lock);
+
+    pthread_join(queue->runner, NULL);
+    pthread_mutex_destroy(&queue->lock);
+    pthread_cond_destroy(&queue->queued);
+    free(queue);
+}
+
+// Solves the first count requests of block on the queue's workers, and
+// returns when all of them are solved.
+static void solveQueued(requestQueue *queue, serverBlock *block, int count) {
+    block->count = count;
+    block->next = 0;
+    block->left = count;
+
+    pthread_mutex_lock(&queue->lock);
+    queueBlock(queue, block);
+    pthread_cond_broadcast(&queue->queued);
+    while (block->left > 0)
+        pthread_cond_wait(&block->solved, &queue->lock);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+
+// Returns the bound of the first bucket under which at least fraction of
+// the latencies fall, or the slowest latency if that is less.
+static long latencyPercentile(const statsTotals *latency, double fraction) {
+    long seen = 0;
+    int i;
+
+    // the slowest bucket's bound may be past the slowest latency.
+    for (i = 0; i < STATS_BUCKETS; i++) {
+        seen += latency->histogram[i];
+        if (seen >= fraction * latency->puzzles)
+            return ((1L << i) < latency->maxMicros)
+                ? (1L << i) : latency->maxMicros;
+    }
+
+    return latency->maxMicros;
+}
+
+// Writes latency as a line of its words and values to out.
+static void writeLatency(FILE *out, const statsTotals *latency) {
+    fprintf(out, "requests=%ld meanMicros=%ld p50Micros=%ld p99Micros=%ld "
+            "maxMicros=%ld\n", latency->puzzles,
+            (latency->puzzles) ? latency->micros / latency->puzzles : 0,
+            (latency->puzzles) ? latencyPercentile(latency, 0.5) : 0,
+            (latency->puzzles) ? latencyPercentile(latency, 0.99) : 0,
+            latency->maxMicros);
+}
+
+// Writes the answer to request to out.
+static void writeAnswer(FILE *out, const serverRequest *request,
+        const statsTotals *latency) {
+    if (request->kind == REQUEST_INVALID) {
+        fprintf(out, INVALID_LINE " %s\n", request->why);
+        return;
+    }
+    if (request->kind == REQUEST_STATS) {
+        fputs("stats ", out);
+        writeLatency(out, latency);
+        return;
+    }
+
+    // a search that couldn't allocate gave up before it began.
+    if ((request->status == SEARCH_GAVE_UP)
+            || (request->status == SEARCH_NO_MEMORY)) {
+        fputs(GAVE_UP_LINE "\n", out);
+        return;
+    }
+    if (request->status == SEARCH_TIMED_OUT) {
+        fprintf(out, TIMED_OUT_LINE " %ld\n", request->stats.nodes);
+        return;
+    }
+
+    switch (request->kind) {
+        case REQUEST_SOLVE:
+            if (request->status == SEARCH_SOLVED)
+                fprintf(out, "%s\n", request->game);
+            else
+                fputs(NO_SOLUTION_LINE "\n", out);
+            break;
+
+        case REQUEST_COUNT:
+            fprintf(out, "%ld%s\n", request->count, ((request->limit)
+                    && (request->count >= request->limit)) ? "+" : "");
+            break;
+
+        case REQUEST_HINT:
+            if (request->status != SEARCH_SOLVED)
+                fputs(NO_SOLUTION_LINE "\n", out);
+            else if (request->hintCell == -1)
+                fputs("none\n", out);
+            else
+                fprintf(out, "%d %c\n", request->hintCell,
+                        request->game[request->hintCell]);
+            break;
+    }
+}
+
+
+/*======== Connections ===*/
+
+// Serves a connection to the socket, on its own thread, and closes it.
+static void *runConnection(void *context) {
+    serverConnection *connection = context;
+    FILE *out;
+
+    out = fdopen(dup(connection->fd), "w");
+    if (out) {
+        serveConnection(connection->fd, out, connection->options,
+                connection->number);
+        fclose(out);
+    }
+
+    close(connection->fd);
+    free(connection);
+    return NULL;
+}
+
+
+
+/*===========================================================================*/
+/*===== Public Functions. ===================================================*/
+/*===========================================================================*/
+
+void serveConnection(int in, FILE *out, const serverOptions *options,
+        long number) {
+    requestReader *reader;
+    serverRequest *requests;
+    serverBlock block;
+    statsTotals latency;
+    requestQueue *queue = NULL;
+    int size, count, quit = FALSE, i;
+
+    initStatsTotals(&latency);
+
+    // without a queue for the pool, the requests are solved here.
+    if (options->pool)
+        queue = acquireQueue(options->pool);
+
+    // a bigger block keeps every worker busy, a smaller one is answered
+    // sooner.
+    size = SERVER_BLOCK;
+    if (options->pool)
+        size *= poolThreads(options->pool);
+
+    reader = malloc(sizeof(*reader));
+    requests = malloc(size * sizeof(*requests));
+    assert((reader) && (requests));
+    reader->fd = in;
+    reader->start = reader->end = 0;
+    reader->ended = reader->skipping = FALSE;
+    block.requests = requests;
+    block.options = options;
+    pthread_cond_init(&block.solved, NULL);
+
+    while ((!quit) && ((count = readRequests(reader, requests, size)) > 0)) {
+        long start = searchMicros();
+
+        // the time a request has runs from when it was read, however long
+        // it waits for a worker.
+        block.deadline = (options->search.timeLimit)
+            ? searchMicros() + options->search.timeLimit : 0;
+
+        if (queue) {
+            solveQueued(queue, &block, count);
+        } else {
+            for (i = 0; i < count; i++)
+                solveRequest(&block, i, 0);
+        }
+
+        // the latencies so far include the requests before a stats one.
+        for (i = 0; (i < count) && (!quit); i++) {
+            if (requests[i].kind == REQUEST_QUIT) {
+                quit = TRUE;
+                break;
+            }
+
+            writeAnswer(out, &requests[i], &latency);
+            if (requests[i].kind != REQUEST_STATS)
+                addStatsTotals(&latency, &requests[i].stats,
+                        searchMicros() - start);
+        }
+
+        if (fflush(out) != 0)
+            break;
+    }
+
+    if (options->logOut) {
+        fprintf(options->logOut, "connection %ld: ", number);
+        writeLatency(options->logOut, &latency);
+    }
+
+    if (queue)
+        releaseQueue(queue);
+    pthread_cond_destroy(&block.solved);
+    free(reader);
+    free(requests);
+}
+
+int serverRequestsRunning(threadPool *pool) {
+    int running = 0;
+
+    pthread_mutex_lock(&queueLock);
+    if ((sharedQueue) && (sharedQueue->pool == pool)) {
+        pthread_mutex_lock(&sharedQueue->lock);
+        running = sharedQueue->running;
+        pthread_mutex_unlock(&sharedQueue->lock);
+    }
+    pthread_mutex_unlock(&queueLock);
+
+    return running;
+}
+
+int serveSocket(const char *path, const serverOptions *options) {
+    struct sockaddr_un address;
+    struct stat old;
+    requestQueue *queue = NULL;
+    long connections = 0;
+    int listener;
+
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        errno = ENAMETOOLONG;
+        return FALSE;
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+
+    // a client hanging up early is only the end of its connection.
+    signal(SIGPIPE, SIG_IGN);
+
+    // a socket left by a server before is replaced, but nothing else is.
+    if ((stat(path, &old) == 0) && (S_ISSOCK(old.st_mode)))
+        unlink(path);
+
+    listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0)
+        return FALSE;
+    if ((bind(listener, (struct sockaddr *) &address, sizeof(address)) != 0)
+            || (listen(listener, SOMAXCONN) != 0)) {
+        close(listener);
+        return FALSE;
+    }
+
+    // the queue is kept going between connections, not restarted for each.
+    if (options->pool)
+        queue = acquireQueue(options->pool);
+
+    for (;;) {
+        serverConnection *connection;
+        pthread_t thread;
+        int fd;
+
+        fd = accept(listener, NULL, NULL);
+        if (fd < 0) {
+            if ((errno == EINTR) || (errno == ECONNABORTED))
+                continue;
+            break;
+        }
+
+        connection = malloc(sizeof(*connection));
+        assert(connection);
+        connection->fd = fd;
+        connection->number = ++connections;
+        connection->options = options;
+
+        if (pthread_create(&thread, NULL, runConnection, connection) != 0) {
+            close(fd);
+            free(connection);
+            continue;
+        }
+        pthread_detach(thread);
+    }
+
+    close(listener);
+    if (queue)
+        releaseQueue(queue);
+    return FALSE;
+}
@@ -0,0 +1,86 @@
+/*=== Include Guard ===*/
+#ifndef SERVER_H
+#define SERVER_H
+
+
+/*=== Includes ===*/
+
+#include <stdio.h>      // To write the responses to FILE streams.
+#include "sudoku.h"     // To use sudokuGrid.
+#include "pool.h"       // To solve the requests on a threadPool.
+#include "solver.h"     // To use searchOptions.
+#include "cache.h"      // To look up grids solved before.
+#include "batch.h"      // To answer with the same lines as a batch.
+
+
+/*=== Defines ===*/
+
+#define SERVER_BLOCK 64         // The most requests solved together, per
+                                // worker.
+#define SERVER_BUFFER 65536     // Bytes of requests read at once, at most.
+#define SERVER_COUNT_LIMIT 2    // The count a count request stops at, if
+                                // it doesn't say.
+
+
+/*=== Typedefs ===*/
+
+// How to serve requests.
+typedef struct {
+    threadPool *pool;       // The workers to solve on, or NULL to solve on
+                            // each connection's own thread.
+    searchOptions search;   // How to search each grid.
+    solutionCache *cache;   // Solutions to look grids up in first, or NULL.
+    FILE *logOut;           // Where each connection's latencies go when it
+                            // closes, or NULL.
+} serverOptions;
+
+
+/*=== Function Declarations ===*/
+
+// Serves the requests read from the file descriptor in, a line each,
+// writing a line for each to out, in order, until in ends or a quit
+// request. A request is a word, then for all but stats and quit a grid,
+// in the same format as readGrid():
+//  - "solve GRID", answered with the solved grid, or NO_SOLUTION_LINE;
+//  - "count GRID [LIMIT]", answered with the number of solutions, with a
+//    '+' after it if it reached LIMIT (SERVER_COUNT_LIMIT if not given, or
+//    0 for no limit);
+//  - "hint GRID", answered with a BLANK cell with the fewest candidates and
+//    its value in the solution, as "CELL VALUE" with CELL from 0, or "none"
+//    if the grid is full, or NO_SOLUTION_LINE;
+//  - "stats", answered with the latencies of the connection's requests so
+//    far, as "stats requests=N meanMicros=N p50Micros=N p99Micros=N
+//    maxMicros=N", the percentiles rounded up to a power of two (or
+//    down to the slowest);
+//  - "quit", which closes the connection without an answer.
+// A search that runs out of nodes, or of memory to search with, is
+// answered with GAVE_UP_LINE, and one that runs out of time with
+// TIMED_OUT_LINE, a space and the nodes it searched. The time limit of
+// options->search runs from when a request is read. A request that isn't
+// one of these is answered with INVALID_LINE, a space and why. Empty lines
+// are skipped.
+// Requests are pipelined: every whole line read at once, up to
+// SERVER_BLOCK per worker, is solved together and answered with a single
+// flush. A request's latency is from when its block was read to when its
+// answer is written. With a pool, the blocks of every connection served on
+// it at once go in one queue, which its workers take a request at a time
+// from each connection in turn; a slow request only holds up the worker
+// solving it, and the rest of its own block. While the queue runs, the
+// pool runs nothing else. Once the connection is over, its latencies are
+// written to options->logOut as "connection NUMBER: " and the words of a
+// stats answer.
+void serveConnection(int in, FILE *out, const serverOptions *options,
+        long number);
+
+// Returns how many requests the workers of pool are solving right now,
+// for the connections served on it, or 0 if none are being served.
+int serverRequestsRunning(threadPool *pool);
+
+// Listens on a Unix domain socket at path (replacing a socket left there)
+// and serves each connection to it with serveConnection() on a thread of
+// its own, sharing the pool's queue, numbering them from 1.
+// Returns only if the socket can't be set up, or can't accept any more
+// connections, with FALSE.
+int serveSocket(const char *path, const serverOptions *options);
+
+#endif
@@ -0,0 +1,824 @@
+#include <stdlib.h> // To malloc() the search stack.
+#include <time.h>   // To clock_gettime() for time budgets.
+#include "solver.h" // To access solverState and the solver declarations.
+#include "dlx.h"    // To solve with the exact cover engine.
+#include "lockstep.h" // To solve with the lockstep engine.
+#include "tables.h" // To look up the groups of a cell.
+
+/*===========================================================================*/
+/*===== Static Helper Functions. ============================================*/
+/*===========================================================================*/
+
+/*======== Instrumentation ===*/
+
+#ifdef SUDOKU_STATS
+// Counts kept by helpers that have no search to put them in. They are per
+// thread, and each run of a search adds on how far they moved.
+static _Thread_local long candidateChecks, forcedCells;
+#define COUNT_STAT(counter) ((counter)++)
+#else
+#define COUNT_STAT(counter) ((void) 0)
+#endif
+
+// What a search that never started did.
+static const searchStats noStats;
+
+
+/*======== Group Index Helpers ===*/
+
+// These read the tables of tables.h, instead of dividing by GRID_LENGTH.
+
+static inline int rowOf(cell loc) {
+    return cellRows[loc];
+}
+
+static inline int columnOf(cell loc) {
+    return cellColumns[loc];
+}
+
+static inline int subGridOf(cell loc) {
+    return cellSubGrids[loc];
+}
+
+
+static inline cell unitCell(int unit, int k) {
+    // the k'th cell of a unit: the first GRID_LENGTH units are the rows,
+    // then the columns, then the sub-grids.
+    return unitCells[unit][k];
+}
+
+
+/*======== Value and Mask Conversion ===*/
+
+static inline candidateMask maskOf(value moveValue) {
+    return (1u << VALUE_INDEX(moveValue));
+}
+
+static inline value valueOf(candidateMask bit) {
+    // the index of the lowest set bit is the offset from MIN_VALUE.
+    return INDEX_VALUE(__builtin_ctz(bit));
+}
+
+
+/*======== Propagation Helpers ===*/
+
+static int placeNakedSingles(solverState *state, int *changed) {
+    cell i;
+
+    for (i = 0; i < GRID_SIZE; i++) {
+        candidateMask candidates;
+        int ok;
+
+        if (state->game[i] != BLANK)
+            continue;
+
+        // no candidates is a dead end; one is a forced value.
+        candidates = getCandidates(state, i);
+        if (!candidates)
+            return FALSE;
+
+        if (!(candidates & (candidates - 1))) {
+            ok = stateSetCell(state, i, valueOf(candidates));
+            assert(ok);
+            COUNT_STAT(forcedCells);
+            *changed = TRUE;
+        }
+    }
+
+    return TRUE;
+}
+
+static int placeHiddenSingles(solverState *state, int *changed) {
+    int unit, k;
+
+    for (unit = 0; unit < (GRID_LENGTH * 3); unit++) {
+        candidateMask once = 0, twice = 0, placed = 0, hidden;
+
+        // find the values with one cell, and the values with more.
+        for (k = 0; k < GRID_LENGTH; k++) {
+            cell i = unitCell(unit, k);
+
+            if (state->game[i] == BLANK) {
+                candidateMask candidates = getCandidates(state, i);
+                twice |= (once & candidates);
+                once |= candidates;
+            } else {
+                placed |= maskOf(state->game[i]);
+            }
+        }
+
+        // every value must go somewhere in the unit.
+        if ((once | placed) != ALL_CANDIDATES)
+            return FALSE;
+
+        hidden = (once & ~twice);
+        if (!hidden)
+            continue;
+
+        for (k = 0; k < GRID_LENGTH; k++) {
+            cell i = unitCell(unit, k);
+            candidateMask forced;
+
+            if (state->game[i] != BLANK)
+                continue;
+
+            // a cell that is the only home of two values is a dead end.
+            forced = (getCandidates(state, i) & hidden);
+            if (forced) {
+                if ((forced & (forced - 1))
+                        || (!stateSetCell(state, i, valueOf(forced))))
+                    return FALSE;
+                COUNT_STAT(forcedCells);
+                *changed = TRUE;
+            }
+        }
+    }
+
+    return TRUE;
+}
+
+static void eliminateOutside(solverState *state, int unit, int otherUnit,
+        candidateMask values, int *changed) {
+    int k;
+
+    // rule values out of the cells of unit that aren't in otherUnit.
+    for (k = 0; k < GRID_LENGTH; k++) {
+        cell i = unitCell(unit, k);
+
+        if ((state->game[i] != BLANK)
+                || ((unit < GRID_LENGTH * 2)
+                    && (subGridOf(i) == otherUnit - (GRID_LENGTH * 2)))
+                || ((unit >= GRID_LENGTH * 2) && (otherUnit < GRID_LENGTH)
+                    && (rowOf(i) == otherUnit))
+                || ((unit >= GRID_LENGTH * 2) && (otherUnit >= GRID_LENGTH)
+                    && (columnOf(i) == otherUnit - GRID_LENGTH)))
+            continue;
+
+        if (getCandidates(state, i) & values) {
+            state->allowed[i] &= ~values;
+            *changed = TRUE;
+        }
+    }
+}
+
+static void eliminateLocked(solverState *state, int *changed) {
+    int box, line, j, k;
+
+    // pointing: values in a sub-grid confined to one of its rows or columns.
+    for (box = 0; box < GRID_LENGTH; box++) {
+        candidateMask inRow[GRID_SUB_LENGTH] = {0};
+        candidateMask inColumn[GRID_SUB_LENGTH] = {0};
+        int boxUnit = box + (GRID_LENGTH * 2);
+
+        for (k = 0; k < GRID_LENGTH; k++) {
+            cell i = unitCell(boxUnit, k);
+
+            if (state->game[i] == BLANK) {
+                inRow[k / GRID_SUB_LENGTH] |= getCandidates(state, i);
+                inColumn[k % GRID_SUB_LENGTH] |= getCandidates(state, i);
+            }
+        }
+
+        for (j = 0; j < GRID_SUB_LENGTH; j++) {
+            candidateMask otherRows = 0, otherColumns = 0;
+            cell corner = unitCell(boxUnit, j * (GRID_SUB_LENGTH + 1));
+
+            for (k = 0; k < GRID_SUB_LENGTH; k++) {
+                if (k != j) {
+                    otherRows |= inRow[k];
+                    otherColumns |= inColumn[k];
+                }
+            }
+
+            // the j'th row and column of the box both cross its corner cell.
+            if (inRow[j] & ~otherRows)
+                eliminateOutside(state, rowOf(corner), boxUnit,
+                        inRow[j] & ~otherRows, changed);
+            if (inColumn[j] & ~otherColumns)
+                eliminateOutside(state, columnOf(corner) + GRID_LENGTH,
+                        boxUnit, inColumn[j] & ~otherColumns, changed);
+        }
+    }
+
+    // claiming: values in a row or column confined to one of its sub-grids.
+    for (line = 0; line < (GRID_LENGTH * 2); line++) {
+        candidateMask inBox[GRID_SUB_LENGTH] = {0};
+
+        for (k = 0; k < GRID_LENGTH; k++) {
+            cell i = unitCell(line, k);
+
+            if (state->game[i] == BLANK)
+                inBox[k / GRID_SUB_LENGTH] |= getCandidates(state, i);
+        }
+
+        for (j = 0; j < GRID_SUB_LENGTH; j++) {
+            candidateMask others = 0;
+
+            for (k = 0; k < GRID_SUB_LENGTH; k++) {
+                if (k != j)
+                    others |= inBox[k];
+            }
+
+            if (inBox[j] & ~others)
+                eliminateOutside(state,
+                        subGridOf(unitCell(line, j * GRID_SUB_LENGTH))
+                            + (GRID_LENGTH * 2),
+                        line, inBox[j] & ~others, changed);
+        }
+    }
+}
+
+
+/*======== Random Orders ===*/
+
+// Returns one of the values of untried, which has some, each as likely as
+// the others.
+static candidateMask randomBit(candidateMask untried,
+        unsigned long long *random) {
+    int skip = (int) (nextRandom(random) % __builtin_popcount(untried));
+
+    while (skip--)
+        untried &= untried - 1;
+
+    return untried & -untried;
+}
+
+// Returns the BLANK cell chooseCell() would with BRANCH_MRV, but of the
+// cells with the fewest candidates (past one), any one as likely as the
+// others; or -1 if there are none.
+static cell chooseRandomCell(const solverState *state,
+        unsigned long long *random) {
+    cell i, best = -1;
+    int bestCount = GRID_LENGTH + 1, ties = 0;
+
+    for (i = 0; i < GRID_SIZE; i++) {
+        int count;
+
+        if (state->game[i] != BLANK)
+            continue;
+
+        count = __builtin_popcount(getCandidates(state, i));
+
+        // nothing fits here, so this is a dead end, and a forced cell takes
+        // its value whichever is taken first; branch on either at once.
+        if (count <= 1)
+            return i;
+
+        // the k'th equal cell replaces the best with a chance of 1 in k,
+        // which leaves each of them kept with the same chance.
+        if (count < bestCount) {
+            best = i;
+            bestCount = count;
+            ties = 1;
+        } else if ((count == bestCount)
+                && (nextRandom(random) % ++ties == 0)) {
+            best = i;
+        }
+    }
+
+    return best;
+}
+
+
+/*======== Search Helpers ===*/
+
+static void undoFrame(searchStack *search, searchFrame *frame) {
+    int ok;
+
+    // put the state back to how it was before the frame's guess.
+    if (frame->placed) {
+        COUNT_STAT(search->stats.backtracks);
+        if (search->options.propagate) {
+            search->state = frame->saved;
+        } else {
+            ok = stateClearCell(&search->state, frame->branchCell);
+            assert(ok);
+        }
+        frame->placed = FALSE;
+    }
+}
+
+// Searches the node in search->state, pushing a frame to branch on.
+// Returns SEARCH_SOLVED if the node is a solution, and SEARCH_GAVE_UP
+// otherwise; a dead end pushes no frame.
+static int expandNode(searchStack *search) {
+    searchFrame *frame;
+    cell candidateCell;
+
+    search->expand = FALSE;
+    search->stats.nodes++;
+
+    if ((search->options.propagate) && (!propagateState(&search->state)))
+        return SEARCH_GAVE_UP;
+
+    // if there are no blank cells, then the grid is solved.
+    if ((search->options.seed) && (search->options.branch == BRANCH_MRV))
+        candidateCell = chooseRandomCell(&search->state, &search->random);
+    else
+        candidateCell = chooseCell(&search->state, &search->options);
+    if (candidateCell == -1)
+        return SEARCH_SOLVED;
+
+    frame = &search->frames[search->depth++];
+#ifdef SUDOKU_STATS
+    if (search->depth > search->stats.maxDepth)
+        search->stats.maxDepth = search->depth;
+#endif
+    frame->branchCell = candidateCell;
+    frame->untried = getCandidates(&search->state, candidateCell);
+    frame->placed = FALSE;
+    if (search->options.propagate)
+        frame->saved = search->state;
+
+    return SEARCH_GAVE_UP;
+}
+
+// Runs a search on, as runSearch() does, without keeping count of what the
+// helpers do.
+static int searchNodes(searchStack *search, long maxNodes, long maxMicros) {
+    long lastNode, deadline;
+
+    // keep to the earlier of the two times.
+    lastNode = search->stats.nodes + maxNodes;
+    deadline = search->options.deadline;
+    if ((maxMicros) && ((!deadline)
+                || (searchMicros() + maxMicros < deadline)))
+        deadline = searchMicros() + maxMicros;
+
+    for (;;) {
+        searchFrame *frame;
+        candidateMask bit;
+        int ok;
+
+        if (search->expand) {
+
+            // stop before the node, so a resumed search starts on it.
+            if ((maxNodes) && (search->stats.nodes >= lastNode))
+                return SEARCH_GAVE_UP;
+
+            // the clock, or another thread, may have called the search off.
+            if ((search->stats.nodes % STOP_CHECK_NODES == 0)
+                    && (((deadline) && (searchMicros() >= deadline))
+                        || (searchCancelled(&search->options))))
+                return SEARCH_TIMED_OUT;
+
+            // count the solution, and carry on unless there are enough.
+            if (expandNode(search) == SEARCH_SOLVED) {
+                if (search->solutions++ == 0)
+                    memcpy(search->firstSolution, search->state.game,
+                            sizeof(sudokuGrid));
+
+                if ((search->solutionLimit)
+                        && (search->solutions >= search->solutionLimit)) {
+                    search->status = SEARCH_SOLVED;
+                    return SEARCH_SOLVED;
+                }
+            }
+        }
+
+        // go back to the deepest branch with values left to try.
+        for (;;) {
+            if (search->depth == 0) {
+                search->status = (search->solutions)
+                        ? SEARCH_SOLVED : SEARCH_NO_SOLUTION;
+                return search->status;
+            }
+
+            frame = &search->frames[search->depth - 1];
+            undoFrame(search, frame);
+            if (frame->untried)
+                break;
+
+            search->depth--;
+        }
+
+        // try the lowest value left, or any when seeded, as a new node.
+        if (search->options.seed)
+            bit = randomBit(frame->untried, &search->random);
+        else
+            bit = frame->untried & -frame->untried;
+        frame->untried &= ~bit;
+
+        ok = stateSetCell(&search->state, frame->branchCell, valueOf(bit));
+        assert(ok);
+        frame->placed = TRUE;
+        search->expand = TRUE;
+    }
+}
+
+// Searches from state as searchState() does with restarts, leaving the last
+// run in search, and what every run did in *stats.
+// Returns the status of the last run, as runSearch() does.
+static int restartSearch(searchStack *search, const solverState *state,
+        const searchOptions *options, searchStats *stats) {
+    searchOptions run = *options;
+    long used = 0, budget, r;
+    int status;
+
+    // the time limit covers every run, so keep to it as a deadline.
+    if ((run.timeLimit) && ((!run.deadline)
+                || (searchMicros() + run.timeLimit < run.deadline)))
+        run.deadline = searchMicros() + run.timeLimit;
+    run.timeLimit = 0;
+    *stats = noStats;
+
+    for (r = 0; ; r++) {
+        budget = options->restartNodes * lubyTerm(r + 1);
+        if ((options->nodeLimit) && (budget > options->nodeLimit - used))
+            budget = options->nodeLimit - used;
+
+        run.seed = options->seed ^ ((unsigned long long) r * RESTART_SEED_STEP);
+        initSearch(search, state, &run);
+        status = runSearch(search, budget, 0);
+        addStats(stats, &search->stats);
+        used += search->stats.nodes;
+
+        // out of nodes is only the end of a run, until the limit is spent.
+        if ((status != SEARCH_GAVE_UP)
+                || ((options->nodeLimit) && (used >= options->nodeLimit)))
+            return status;
+    }
+}
+
+/*===========================================================================*/
+/*===== Public Functions. ===================================================*/
+/*===========================================================================*/
+
+/*======== State Functions ===*/
+
+int searchCancelled(const searchOptions *options) {
+    return (((options->cancel) && (atomic_load_explicit(options->cancel,
+                        memory_order_relaxed)))
+            || ((options->parentCancel) && (atomic_load_explicit(
+                        options->parentCancel, memory_order_relaxed))));
+}
+
+void initOptions(searchOptions *options) {
+    options->engine = ENGINE_BACKTRACK;
+    options->branch = BRANCH_MRV;
+    options->tieBreak = TIE_FIRST;
+    options->propagate = TRUE;
+    options->nodeLimit = 0;
+    options->timeLimit = 0;
+    options->deadline = 0;
+    options->cancel = NULL;
+    options->parentCancel = NULL;
+    options->seed = 0;
+    options->restartNodes = 0;
+    options->stats = NULL;
+}
+
+long long searchNanos(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((long long) now.tv_sec * 1000000000LL) + now.tv_nsec;
+}
+
+long searchMicros(void) {
+    return (long) (searchNanos() / 1000);
+}
+
+unsigned long long nextRandom(unsigned long long *seed) {
+    unsigned long long z = (*seed += 0x9e3779b97f4a7c15ULL);
+
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+long lubyTerm(long index) {
+    long size;
+
+    // the sequence up to each 2^k - 1 ends in 2^(k - 1), after two copies
+    // of the sequence up to 2^(k - 1) - 1; an index in the second copy is
+    // the same as in the first.
+    for (;;) {
+        size = 1;
+        while (size < index)
+            size = (size * 2) + 1;
+
+        if (size == index)
+            return (size + 1) / 2;
+        index -= size / 2;
+    }
+}
+
+void addStats(searchStats *total, const searchStats *part) {
+    total->nodes += part->nodes;
+#ifdef SUDOKU_STATS
+    total->candidateChecks += part->candidateChecks;
+    total->backtracks += part->backtracks;
+    total->forced += part->forced;
+    if (part->maxDepth > total->maxDepth)
+        total->maxDepth = part->maxDepth;
+#endif
+}
+
+int initState(solverState *state, sudokuGrid game) {
+    cell i;
+
+    if (!isValid(game))
+        return FALSE;
+
+    // start with every value free everywhere.
+    for (i = 0; i < GRID_LENGTH; i++) {
+        state->rows[i] = ALL_CANDIDATES;
+        state->columns[i] = ALL_CANDIDATES;
+        state->subGrids[i] = ALL_CANDIDATES;
+    }
+    for (i = 0; i < GRID_SIZE; i++)
+        state->allowed[i] = ALL_CANDIDATES;
+
+    // start from an empty grid, and place every given value into it, so
+    // that clashing givens are caught here instead of during the search.
+    memset(state->game, BLANK, GRID_SIZE);
+    state->game[GRID_SIZE] = '\0';
+    for (i = 0; i < GRID_SIZE; i++) {
+        if (game[i] != BLANK) {
+            if (!stateSetCell(state, i, game[i]))
+                return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+candidateMask getCandidates(const solverState *state, cell targetCell) {
+    COUNT_STAT(candidateChecks);
+    return (state->rows[rowOf(targetCell)]
+            & state->columns[columnOf(targetCell)]
+            & state->subGrids[subGridOf(targetCell)]
+            & state->allowed[targetCell]);
+}
+
+int stateSetCell(solverState *state, cell targetCell, value moveValue) {
+    candidateMask bit;
+
+    // the cell must be a BLANK one, and the value must be a non-BLANK one.
+    if ((targetCell < 0) || (targetCell >= GRID_SIZE)
+            || (state->game[targetCell] != BLANK)
+            || (moveValue == BLANK) || (!isValidValue(moveValue)))
+        return FALSE;
+
+    // the value must still be free in the cell's column, row and sub-grid.
+    bit = maskOf(moveValue);
+    if (!(getCandidates(state, targetCell) & bit))
+        return FALSE;
+
+    if (!setCell(state->game, targetCell, moveValue))
+        return FALSE;
+
+    // the value is now taken.
+    state->rows[rowOf(targetCell)] &= ~bit;
+    state->columns[columnOf(targetCell)] &= ~bit;
+    state->subGrids[subGridOf(targetCell)] &= ~bit;
+
+    return TRUE;
+}
+
+int stateClearCell(solverState *state, cell targetCell) {
+    candidateMask bit;
+
+    // there must be a value in the cell to take out.
+    if ((targetCell < 0) || (targetCell >= GRID_SIZE)
+            || (state->game[targetCell] == BLANK))
+        return FALSE;
+
+    bit = maskOf(state->game[targetCell]);
+    if (!clearCell(state->game, targetCell))
+        return FALSE;
+
+    // the value is free again.
+    state->rows[rowOf(targetCell)] |= bit;
+    state->columns[columnOf(targetCell)] |= bit;
+    state->subGrids[subGridOf(targetCell)] |= bit;
+
+    return TRUE;
+}
+
+
+/*======== Search Functions ===*/
+
+int propagateState(solverState *state) {
+    int changed;
+
+    // try the cheap rules first, and only go on when they are stuck.
+    do {
+        changed = FALSE;
+
+        if (!placeNakedSingles(state, &changed))
+            return FALSE;
+        if (changed)
+            continue;
+
+        if (!placeHiddenSingles(state, &changed))
+            return FALSE;
+        if (changed)
+            continue;
+
+        eliminateLocked(state, &changed);
+    } while (changed);
+
+    return TRUE;
+}
+
+cell chooseCell(const solverState *state, const searchOptions *options) {
+    cell i, best;
+    int bestCount, bestDegree;
+
+    if ((!options) || (options->branch == BRANCH_MRV)) {
+        int tieBreak = (options) ? options->tieBreak : TIE_FIRST;
+
+        best = -1;
+        bestCount = GRID_LENGTH + 1;
+        bestDegree = -1;
+
+        for (i = 0; i < GRID_SIZE; i++) {
+            int count, degree;
+
+            if (state->game[i] != BLANK)
+                continue;
+
+            count = __builtin_popcount(getCandidates(state, i));
+
+            // nothing fits here, so this is a dead end; branch on it at once.
+            if (count == 0)
+                return i;
+
+            // the free values in a group are as many as its BLANK cells.
+            degree = 0;
+            if (tieBreak == TIE_DEGREE) {
+                degree = (__builtin_popcount(state->rows[rowOf(i)])
+                        + __builtin_popcount(state->columns[columnOf(i)])
+                        + __builtin_popcount(state->subGrids[subGridOf(i)]));
+            }
+
+            if ((count < bestCount)
+                    || ((count == bestCount) && (tieBreak == TIE_LAST))
+                    || ((count == bestCount) && (degree > bestDegree))) {
+                best = i;
+                bestCount = count;
+                bestDegree = degree;
+
+                // a forced cell can't be beaten when the first one wins.
+                if ((count == 1) && (tieBreak == TIE_FIRST))
+                    break;
+            }
+        }
+
+        return best;
+    }
+
+    // otherwise just the first BLANK cell.
+    return getBlankCell((value *) state->game);
+}
+
+void initSearch(searchStack *search, const solverState *state,
+        const searchOptions *options) {
+    search->state = *state;
+    search->depth = 0;
+    search->expand = TRUE;
+    search->status = SEARCH_GAVE_UP;
+    search->stats = noStats;
+    search->solutions = 0;
+    search->solutionLimit = 1;
+
+    if (options)
+        search->options = *options;
+    else
+        initOptions(&search->options);
+    search->random = search->options.seed;
+}
+
+int runSearch(searchStack *search, long maxNodes, long maxMicros) {
+    int status;
+#ifdef SUDOKU_STATS
+    long checks = candidateChecks, forced = forcedCells;
+#endif
+
+    // a search that is over stays over.
+    if (search->status != SEARCH_GAVE_UP)
+        return search->status;
+
+    status = searchNodes(search, maxNodes, maxMicros);
+#ifdef SUDOKU_STATS
+    search->stats.candidateChecks += candidateChecks - checks;
+    search->stats.forced += forcedCells - forced;
+#endif
+
+    return status;
+}
+
+int solveState(solverState *state) {
+    return (searchState(state, NULL, NULL) == SEARCH_SOLVED);
+}
+
+int searchState(solverState *state, const searchOptions *options,
+        long *nodes) {
+    searchStack *search;
+    searchStats stats;
+    long maxNodes, maxMicros;
+    int status;
+
+    // the stack is too big to keep on the thread's own.
+    search = malloc(sizeof(*search));
+    if (!search) {
+        if (nodes)
+            *nodes = 0;
+        if ((options) && (options->stats))
+            *options->stats = noStats;
+        return SEARCH_NO_MEMORY;
+    }
+
+    if ((options) && (options->seed) && (options->restartNodes)) {
+        status = restartSearch(search, state, options, &stats);
+    } else {
+        initSearch(search, state, options);
+
+        maxNodes = (options) ? options->nodeLimit : 0;
+        maxMicros = (options) ? options->timeLimit : 0;
+        status = runSearch(search, maxNodes, maxMicros);
+        stats = search->stats;
+    }
+
+    if (status == SEARCH_SOLVED)
+        *state = search->state;
+    if (nodes)
+        *nodes = stats.nodes;
+    if ((options) && (options->stats))
+        *options->stats = stats;
+
+    free(search);
+    return status;
+}
+
+int solveGrid(sudokuGrid game, const searchOptions *options) {
+    // the grid has already been validated in the read.
+
+    solverState state;
+    int status;
+
+    if ((options) && (options->engine == ENGINE_DLX))
+        return dlxSolveGrid(game, options);
+
+    // a single grid in lockstep takes one lane of the vectors.
+    if ((options) && (options->engine == ENGINE_LOCKSTEP)) {
+        solveLockstep((sudokuGrid *) game, 1, options, &status,
+                options->stats);
+        return status;
+    }
+
+    // build the candidate masks; clashing givens have no solution.
+    if (!initState(&state, game)) {
+        if ((options) && (options->stats))
+            *options->stats = noStats;
+        return SEARCH_NO_SOLUTION;
+    }
+
+    // search for a solution, and copy it back into the game when found.
+    status = searchState(&state, options, NULL);
+    if (status == SEARCH_SOLVED)
+        memcpy(game, state.game, GRID_SIZE);
+
+    return status;
+}
+
+int countGrid(sudokuGrid game, long limit, const searchOptions *options,
+        long *count) {
+    searchStack *search;
+    solverState state;
+    int status;
+
+    *count = 0;
+    if ((options) && (options->engine == ENGINE_DLX))
+        return dlxCountGrid(game, limit, options, count);
+
+    if (!initState(&state, game)) {
+        if ((options) && (options->stats))
+            *options->stats = noStats;
+        return SEARCH_NO_SOLUTION;
+    }
+
+    search = malloc(sizeof(*search));
+    if (!search) {
+        if ((options) && (options->stats))
+            *options->stats = noStats;
+        return SEARCH_NO_MEMORY;
+    }
+    initSearch(search, &state, options);
+    search->solutionLimit = limit;
+
+    status = runSearch(search, (options) ? options->nodeLimit : 0,
+            (options) ? options->timeLimit : 0);
+    *count = search->solutions;
+    if ((options) && (options->stats))
+        *options->stats = search->stats;
+
+    free(search);
+    return status;
+}
+
+int hasSolution(sudokuGrid game) {
+    return (solveGrid(game, NULL) == SEARCH_SOLVED);
+}
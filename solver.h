@@ -0,0 +1,268 @@
+/*=== Include Guard ===*/
+#ifndef SOLVER_H
+#define SOLVER_H
+
+
+/*=== Includes ===*/
+
+#include <stdatomic.h>  // To be cancelled from other threads.
+#include "sudoku.h"     // To use sudokuGrid, cell and value.
+
+
+/*=== Defines ===*/
+
+#define ALL_CANDIDATES ((1u << GRID_LENGTH) - 1) // Every value is free.
+
+#define ENGINE_BACKTRACK 0  // Search with solverState and propagation.
+#define ENGINE_DLX 1        // Search the exact cover matrix, in dlx.c.
+#define ENGINE_LOCKSTEP 2   // Propagate grids in vector lanes, in lockstep.c,
+                            // and search the rest with ENGINE_BACKTRACK.
+
+#define BRANCH_FIRST 0  // Branch on the first BLANK cell, in row-major order.
+#define BRANCH_MRV 1    // Branch on the BLANK cell with the fewest candidates.
+
+#define SEARCH_NO_SOLUTION 0    // The search is over, and found nothing.
+#define SEARCH_SOLVED 1         // The search found a solution.
+#define SEARCH_GAVE_UP 2        // The search ran out of nodes before it was
+                                // over.
+#define SEARCH_TIMED_OUT 3      // The search passed its deadline or time
+                                // limit, or was cancelled, before it was
+                                // over.
+#define SEARCH_NO_MEMORY 4      // The search couldn't allocate what it
+                                // needed, so didn't run.
+
+// If a search ended with an answer, rather than stopping short of one.
+#define SEARCH_OVER(status) \
+    (((status) == SEARCH_SOLVED) || ((status) == SEARCH_NO_SOLUTION))
+
+#define STOP_CHECK_NODES 256    // Nodes between looks at the clock and at
+                                // the cancel token.
+
+#define RESTART_SEED_STEP 0xbf58476d1ce4e5b9ULL // Odd, so every restart
+                                                // is seeded differently.
+
+#define TIE_FIRST 0     // Of equal cells, take the first in row-major order.
+#define TIE_LAST 1      // Of equal cells, take the last in row-major order.
+#define TIE_DEGREE 2    // Of equal cells, take the one whose column, row and
+                        // sub-grid have the most BLANK cells.
+
+
+/*=== Typedefs ===*/
+
+// A set of values, one bit per value: bit 0 is MIN_VALUE, bit 1 the next...
+typedef unsigned int candidateMask;
+
+// A grid together with the values still free in each of its columns, rows
+// and sub-grids. The masks are kept in step with the grid by stateSetCell()
+// and stateClearCell(), so the legal values of a cell are three ANDs away.
+// Propagation can also rule values out of single cells, in allowed; those
+// are only undone by restoring a copy of the state.
+typedef struct {
+    sudokuGrid game;                        // The grid being solved.
+    candidateMask rows[GRID_LENGTH];        // Values free in each row.
+    candidateMask columns[GRID_LENGTH];     // Values free in each column.
+    candidateMask subGrids[GRID_LENGTH];    // Values free in each sub-grid.
+    candidateMask allowed[GRID_SIZE];       // Values not ruled out of a cell.
+} solverState;
+
+// What a search did, for measuring it. Only the nodes are counted unless
+// built with SUDOKU_STATS, since the rest cost a little on every node.
+typedef struct {
+    long nodes;             // Nodes searched.
+#ifdef SUDOKU_STATS
+    long candidateChecks;   // Lookups of a cell's legal values.
+    long backtracks;        // Guesses taken back.
+    long forced;            // Cells filled in by propagation.
+    int maxDepth;           // The most guesses in force at once.
+#endif
+} searchStats;
+
+// How to search. A NULL searchOptions means the defaults set by
+// initOptions(): ENGINE_BACKTRACK, BRANCH_MRV, TIE_FIRST, propagating, no
+// budget or deadline, never cancelled, in order rather than at random, and
+// with no stats kept.
+// The clock and cancel are only looked at every STOP_CHECK_NODES nodes, so
+// they cost next to nothing, and a search stops within that many nodes of
+// them firing.
+typedef struct {
+    int engine;             // ENGINE_BACKTRACK, ENGINE_DLX or
+                            // ENGINE_LOCKSTEP, for solveGrid();
+                            // countGrid() counts ENGINE_LOCKSTEP with
+                            // ENGINE_BACKTRACK.
+    int branch;             // BRANCH_FIRST or BRANCH_MRV.
+    int tieBreak;           // TIE_FIRST, TIE_LAST or TIE_DEGREE, for MRV.
+    int propagate;          // Deduce forced values before every branch.
+    long nodeLimit;         // Nodes to search before giving up, or 0.
+    long timeLimit;         // Microseconds to search before timing out, or 0.
+    long deadline;          // The searchMicros() to time out at, or 0; the
+                            // earlier of it and timeLimit is kept to.
+    atomic_int *cancel;     // Times the search out once set; NULL is never
+                            // set.
+    atomic_int *parentCancel;   // Does the same as cancel, for a search
+                            // with a token of its own run for a caller
+                            // with another, such as solveParallel()'s.
+    unsigned long long seed;    // For ENGINE_BACKTRACK, tries each branch's
+                            // values in a random order, and breaks
+                            // BRANCH_MRV's ties at random instead of by
+                            // tieBreak, from this seed; 0 keeps to order.
+    long restartNodes;      // With a seed, searchState() restarts a solve
+                            // after this many nodes times the next term of
+                            // the Luby sequence (1, 1, 2, 1, 1, 2, 4...),
+                            // each time with a new seed, or 0 for none.
+    searchStats *stats;     // Filled in by searchState(), solveGrid() and
+                            // countGrid(), if not NULL.
+} searchOptions;
+
+// A branch of the search: the cell it is on, and the candidates it has yet
+// to try. When propagating, the state before the branch is kept to go
+// back to, since propagation can't be undone cell by cell.
+typedef struct {
+    cell branchCell;
+    candidateMask untried;
+    int placed;             // If branchCell holds a value being tried.
+    solverState saved;
+} searchFrame;
+
+// A search in progress, with its branches on an explicit stack, so that
+// it can be stopped at any node and resumed later with runSearch().
+typedef struct {
+    solverState state;                  // The grid as far as it has got.
+    searchFrame frames[GRID_SIZE];      // The branches, root first.
+    int depth;                          // The number of frames in use.
+    int expand;                         // If state is a node not yet seen.
+    int status;                         // SEARCH_GAVE_UP until it's over.
+    searchStats stats;                  // What it did, over all runs.
+    long solutions;                     // Solutions found so far.
+    long solutionLimit;                 // Solutions to stop at, 0 for all.
+    unsigned long long random;          // The random orders' generator.
+    sudokuGrid firstSolution;           // The first solution found.
+    searchOptions options;
+} searchStack;
+
+
+/*=== Function Declarations ===*/
+
+// Sets options to the defaults.
+void initOptions(searchOptions *options);
+
+// Returns whether options' cancel or parentCancel has been set.
+int searchCancelled(const searchOptions *options);
+
+// Returns the time in nanoseconds on the monotonic clock that deadlines
+// are on, for anything that needs to time less than a microsecond.
+long long searchNanos(void);
+
+// Returns the time in microseconds on the monotonic clock that deadlines
+// are on.
+long searchMicros(void);
+
+// Steps the random number generator whose state is *seed (splitmix64, so
+// any seed will do, and each thread can keep its own).
+// Returns the next random number.
+unsigned long long nextRandom(unsigned long long *seed);
+
+// Returns the index'th term of the Luby sequence, from 1: 1, 1, 2, 1, 1, 2,
+// 4, 1, 1, 2, 1, 1, 2, 4, 8... Restarting after these many units each time
+// is within a log factor of the best fixed schedule, without knowing it.
+long lubyTerm(long index);
+
+// Adds the counts of part into total, keeping the deeper maxDepth.
+void addStats(searchStats *total, const searchStats *part);
+
+// Copies a valid grid into state and builds its masks.
+// Returns FALSE if the grid is invalid, or if two of its values already
+// clash in a column, row or sub-grid.
+int initState(solverState *state, sudokuGrid game);
+
+// Returns the set of values that can legally go in targetCell.
+candidateMask getCandidates(const solverState *state, cell targetCell);
+
+// Sets a BLANK cell to a legal value, and takes the value out of the masks
+// of its column, row and sub-grid.
+// Returns TRUE or FALSE based on success.
+int stateSetCell(solverState *state, cell targetCell, value moveValue);
+
+// Sets a cell back to BLANK, and puts its value back in the masks of its
+// column, row and sub-grid.
+// Returns TRUE or FALSE based on success.
+int stateClearCell(solverState *state, cell targetCell);
+
+// Fills in the values that are forced, and rules out values that can't be
+// used, until nothing more follows:
+//  - naked singles, cells with a single candidate;
+//  - hidden singles, values with a single cell left in a column, row or
+//    sub-grid;
+//  - locked candidates, values whose cells in a sub-grid all lie in one
+//    row or column (which rules the value out of the rest of that row or
+//    column), or whose cells in a row or column all lie in one sub-grid
+//    (which rules it out of the rest of that sub-grid).
+// Returns FALSE if the grid turns out to have no solution, in which case
+// the state is left part way through.
+int propagateState(solverState *state);
+
+// Returns the BLANK cell the search branches on next, chosen as options
+// say, or -1 if there are none. With BRANCH_MRV, a cell with no candidates
+// is returned as soon as it is found, since the search can prune there.
+cell chooseCell(const solverState *state, const searchOptions *options);
+
+// Starts a search from a copy of state, searching as options say (their
+// node and time limits are not used, since runSearch() is given its own,
+// but their deadline and cancel are). The search stops at the first
+// solution; set solutionLimit after this to count more.
+void initSearch(searchStack *search, const solverState *state,
+        const searchOptions *options);
+
+// Runs a search on for up to maxNodes more nodes and maxMicros more
+// microseconds (0 for no limit on either), or until the options' deadline
+// or cancel. Each node is a grid reached by a guess, or the starting grid; it
+// is propagated, if the options say to, then branched on. A solution
+// that doesn't reach solutionLimit is counted and backtracked from.
+// Returns SEARCH_SOLVED, once there are solutions and the search is over
+// or has reached solutionLimit (the last solution is then in
+// search->state); or SEARCH_NO_SOLUTION; or SEARCH_GAVE_UP, out of nodes,
+// or SEARCH_TIMED_OUT, out of time or cancelled, after either of which
+// calling runSearch() again carries on from where it stopped.
+int runSearch(searchStack *search, long maxNodes, long maxMicros);
+
+// Fills in the BLANK cells of state by backtracking over the candidates,
+// with the default options. When propagating, the state is copied before
+// each guess, and restored from the copy when the guess fails.
+// On failure the state is left as it was passed.
+// Returns TRUE or FALSE depending if a solution was found.
+int solveState(solverState *state);
+
+// The same as solveState(), but searches as options say, within their
+// budgets. If nodes is not NULL, the nodes searched are put there, however
+// the search ended.
+// With a seed and restartNodes, the search is run again from state each
+// time its next Luby budget runs out, with the seed of run r (from 0) set
+// to seed ^ (r * RESTART_SEED_STEP); the node limit and stats cover every
+// run. Each budget is larger in the end, so the search still ends.
+// On failure the state is left as it was passed.
+// Returns SEARCH_SOLVED, SEARCH_NO_SOLUTION, SEARCH_GAVE_UP,
+// SEARCH_TIMED_OUT or SEARCH_NO_MEMORY.
+int searchState(solverState *state, const searchOptions *options,
+        long *nodes);
+
+// Solves a valid grid in place with the engine of options, leaving it
+// untouched if it has no solution. A search that times out unwinds
+// without a trace, and its stats hold the nodes searched until then.
+// Returns SEARCH_SOLVED, SEARCH_NO_SOLUTION, SEARCH_GAVE_UP,
+// SEARCH_TIMED_OUT or SEARCH_NO_MEMORY.
+int solveGrid(sudokuGrid game, const searchOptions *options);
+
+// Counts the solutions of a valid grid with the engine of options, within
+// their budgets, stopping once there are limit of them (0 for no limit).
+// Propagation keeps every solution, so it is used as when solving. The
+// number found is put in *count, even if the search stopped short.
+// Returns SEARCH_SOLVED if any were found and the count is complete (or
+// reached limit), SEARCH_NO_SOLUTION, SEARCH_GAVE_UP, SEARCH_TIMED_OUT or
+// SEARCH_NO_MEMORY.
+int countGrid(sudokuGrid game, long limit, const searchOptions *options,
+        long *count);
+
+// Solves a valid grid in place with the default options.
+// Returns TRUE or FALSE depending if a solution was found.
+int hasSolution(sudokuGrid game);
+
+#endif
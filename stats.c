@@ -0,0 +1,143 @@
+#include <string.h> // To strcmp() format names.
+#include "stats.h"  // To access statsTotals and the stats declarations.
+
+/*===========================================================================*/
+/*===== Static Helper Functions. ============================================*/
+/*===========================================================================*/
+
+// Returns the histogram bucket of a solve taking micros microseconds.
+static int bucketOf(long micros) {
+    int bucket = 0;
+
+    while ((bucket < STATS_BUCKETS - 1) && (micros >= (1L << bucket)))
+        bucket++;
+
+    return bucket;
+}
+
+// Writes the counts of stats as JSON members, after a comma.
+static void writeJsonCounts(FILE *out, const searchStats *stats) {
+    char text[STATS_JSON_SIZE];
+
+    formatJsonCounts(text, stats);
+    fputs(text, out);
+}
+
+// Writes the counts of stats as CSV fields, or their names if stats is
+// NULL, after a comma.
+static void writeCsvCounts(FILE *out, const searchStats *stats) {
+    if (!stats) {
+        fputs(",nodes", out);
+#ifdef SUDOKU_STATS
+        fputs(",candidateChecks,backtracks,forced,maxDepth", out);
+#endif
+        return;
+    }
+
+    fprintf(out, ",%ld", stats->nodes);
+#ifdef SUDOKU_STATS
+    fprintf(out, ",%ld,%ld,%ld,%d", stats->candidateChecks,
+            stats->backtracks, stats->forced, stats->maxDepth);
+#endif
+}
+
+
+
+/*===========================================================================*/
+/*===== Public Functions. ===================================================*/
+/*===========================================================================*/
+
+int formatJsonCounts(char *text, const searchStats *stats) {
+#ifdef SUDOKU_STATS
+    return snprintf(text, STATS_JSON_SIZE, ",\"nodes\":%ld"
+            ",\"candidateChecks\":%ld,\"backtracks\":%ld,\"forced\":%ld"
+            ",\"maxDepth\":%d", stats->nodes, stats->candidateChecks,
+            stats->backtracks, stats->forced, stats->maxDepth);
+#else
+    return snprintf(text, STATS_JSON_SIZE, ",\"nodes\":%ld", stats->nodes);
+#endif
+}
+
+int parseStatsFormat(const char *name) {
+    if (strcmp(name, "json") == 0)
+        return STATS_JSON;
+    if (strcmp(name, "csv") == 0)
+        return STATS_CSV;
+
+    return STATS_NONE;
+}
+
+void initStatsTotals(statsTotals *totals) {
+    memset(totals, 0, sizeof(*totals));
+}
+
+void addStatsTotals(statsTotals *totals, const searchStats *stats,
+        long micros) {
+    totals->puzzles++;
+    addStats(&totals->total, stats);
+    if (stats->nodes > totals->maxNodes)
+        totals->maxNodes = stats->nodes;
+
+    totals->micros += micros;
+    if (micros > totals->maxMicros)
+        totals->maxMicros = micros;
+    totals->histogram[bucketOf(micros)]++;
+}
+
+void writeStats(FILE *out, int format, long puzzle, const char *outcome,
+        const searchStats *stats, long micros) {
+    switch (format) {
+        case STATS_JSON:
+            fprintf(out, "{\"puzzle\":%ld,\"outcome\":\"%s\",\"micros\":%ld",
+                    puzzle, outcome, micros);
+            writeJsonCounts(out, stats);
+            fputs("}\n", out);
+            break;
+
+        case STATS_CSV:
+            if (puzzle == 1) {
+                fputs("puzzle,outcome,micros", out);
+                writeCsvCounts(out, NULL);
+                putc('\n', out);
+            }
+            fprintf(out, "%ld,%s,%ld", puzzle, outcome, micros);
+            writeCsvCounts(out, stats);
+            putc('\n', out);
+            break;
+    }
+}
+
+void writeStatsTotals(FILE *out, int format, const statsTotals *totals) {
+    int last, i;
+
+    // leave off the empty buckets past the slowest solve.
+    last = bucketOf(totals->maxMicros);
+
+    switch (format) {
+        case STATS_JSON:
+            fprintf(out, "{\"puzzles\":%ld,\"micros\":%ld,\"maxMicros\":%ld"
+                    ",\"maxNodes\":%ld", totals->puzzles, totals->micros,
+                    totals->maxMicros, totals->maxNodes);
+            writeJsonCounts(out, &totals->total);
+
+            fputs(",\"histogram\":[", out);
+            for (i = 0; i <= last; i++) {
+                fprintf(out, "%s{\"underMicros\":%ld,\"puzzles\":%ld}",
+                        (i) ? "," : "", 1L << i, totals->histogram[i]);
+            }
+            fputs("]}\n", out);
+            break;
+
+        case STATS_CSV:
+            fputs("\npuzzles,micros,maxMicros,maxNodes", out);
+            writeCsvCounts(out, NULL);
+            fprintf(out, "\n%ld,%ld,%ld,%ld", totals->puzzles, totals->micros,
+                    totals->maxMicros, totals->maxNodes);
+            writeCsvCounts(out, &totals->total);
+
+            fputs("\n\nunderMicros,puzzles\n", out);
+            for (i = 0; i <= last; i++)
+                fprintf(out, "%ld,%ld\n", 1L << i, totals->histogram[i]);
+            break;
+    }
+}
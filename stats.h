@@ -0,0 +1,66 @@
+/*=== Include Guard ===*/
+#ifndef STATS_H
+#define STATS_H
+
+
+/*=== Includes ===*/
+
+#include <stdio.h>      // To write FILE streams.
+#include "solver.h"     // To use searchStats.
+
+
+/*=== Defines ===*/
+
+#define STATS_NONE 0    // Write no stats.
+#define STATS_JSON 1    // Write an object per line.
+#define STATS_CSV 2     // Write comma separated rows, under a header.
+
+#define STATS_BUCKETS 32    // Latency histogram buckets, doubling from 1us.
+#define STATS_JSON_SIZE 256 // Room for the JSON counts of a solve.
+
+
+/*=== Typedefs ===*/
+
+// The stats of many solves, added up.
+typedef struct {
+    long puzzles;                   // Solves added.
+    searchStats total;              // Their counts, added up.
+    long maxNodes;                  // The most nodes of any one solve.
+    long micros;                    // Their time, added up.
+    long maxMicros;                 // The longest time of any one solve.
+    long histogram[STATS_BUCKETS];  // Solves taking under 1us, under 2us,
+                                    // under 4us...; the last takes the rest.
+} statsTotals;
+
+
+/*=== Function Declarations ===*/
+
+// Writes the counts of stats into text, as JSON members after a comma, and
+// a '\0'. Text must hold STATS_JSON_SIZE chars.
+// Returns the number of chars written, not counting the '\0'.
+int formatJsonCounts(char *text, const searchStats *stats);
+
+// Returns STATS_JSON or STATS_CSV for a format name ("json" or "csv"), or
+// STATS_NONE if the name is not known.
+int parseStatsFormat(const char *name);
+
+// Sets totals to none.
+void initStatsTotals(statsTotals *totals);
+
+// Adds a solve, that searched as stats say in micros microseconds, to
+// totals.
+void addStatsTotals(statsTotals *totals, const searchStats *stats,
+        long micros);
+
+// Writes what a solve did to out in format: the puzzle number, a word for
+// how it ended, its time and its counts. For STATS_CSV, the header is
+// written before puzzle 1.
+void writeStats(FILE *out, int format, long puzzle, const char *outcome,
+        const searchStats *stats, long micros);
+
+// Writes totals to out in format, with its histogram up to the slowest
+// bucket. For STATS_CSV these are two tables of their own, each after an
+// empty line.
+void writeStatsTotals(FILE *out, int format, const statsTotals *totals);
+
+#endif
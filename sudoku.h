@@ -15,14 +15,47 @@
 #define TRUE 1          // Boolean true.
 #define FALSE 0         // Boolean false.
 
+// The grid is built for one size, chosen at compile time by the length of
+// its sub-grids: 3 for 9x9 grids, 4 for 16x16, or 5 for 25x25 (so build with
+// -DGRID_SUB_LENGTH=4 for hexadoku). Everything else follows from it.
+#ifndef GRID_SUB_LENGTH
+#define GRID_SUB_LENGTH 3 // The length of a subGrid.
+#endif
+
+#if (GRID_SUB_LENGTH < 2) || (GRID_SUB_LENGTH > 5)
+#error "GRID_SUB_LENGTH must be from 2 to 5."
+#endif
+
+#define GRID_LENGTH (GRID_SUB_LENGTH * GRID_SUB_LENGTH) // The side length of a grid.
+#define GRID_SIZE (GRID_LENGTH * GRID_LENGTH) // The number of cells in a grid.
+#define GRID_CHUNK (GRID_LENGTH * GRID_SUB_LENGTH) // The distance from the top to the bottom of a subGrid.
+
+// The values are '1' to '9' and then 'A' onwards, as many as GRID_LENGTH:
+// '1' to 'G' for 16x16, and '1' to 'P' for 25x25.
 #define MIN_VALUE '1'   // Minimum value for a sudokuGrid.
-#define MAX_VALUE '9'   // Maximum value for a sudokuGrid.
+#if GRID_LENGTH <= 9
+#define MAX_VALUE ('0' + GRID_LENGTH)       // Maximum value for a sudokuGrid.
+#else
+#define MAX_VALUE ('A' + GRID_LENGTH - 10)  // Maximum value for a sudokuGrid.
+#endif
 #define BLANK '.'       // The character to be used for an undefined value.
 
-#define GRID_LENGTH 9   // The side length of a grid.
-#define GRID_SIZE (GRID_LENGTH * GRID_LENGTH) // The number of cells in a grid.
-#define GRID_CHUNK (GRID_LENGTH * (GRID_LENGTH / 3)) // The distance from the top to the bottom of a subGrid.
-#define GRID_SUB_LENGTH (GRID_LENGTH / 3) // The length of a subGrid.
+// The most chars formatGrid() writes: a blank line, then each row, with two
+// chars and a space per value, two more spaces after each sub-grid, and a
+// blank line after each band.
+#define GRID_TEXT_SIZE (1 + (GRID_LENGTH * \
+            ((GRID_LENGTH * 3) + (GRID_SUB_LENGTH * 2) + 2)))
+
+// The offset of a value from MIN_VALUE, from 0 to GRID_LENGTH - 1, and the
+// value at an offset. With no letters these are a subtraction and an
+// addition, so 9x9 grids pay nothing for the larger sizes.
+#if GRID_LENGTH <= 9
+#define VALUE_INDEX(v) ((v) - MIN_VALUE)
+#define INDEX_VALUE(i) ((value) (MIN_VALUE + (i)))
+#else
+#define VALUE_INDEX(v) (((v) <= '9') ? ((v) - MIN_VALUE) : ((v) - 'A' + 9))
+#define INDEX_VALUE(i) ((value) (((i) < 9) ? (MIN_VALUE + (i)) : ('A' + (i) - 9)))
+#endif
 
 
 /*=== Typedefs ===*/
@@ -30,7 +63,7 @@
 typedef char value;                     // A value of a grid.
 typedef int cell;                       // An index in the grid.
 typedef cell group[GRID_LENGTH];        // A column, row, or sub-grid of cells.
-typedef value sudokuGrid[GRID_SIZE];    // A sudoku grid of concrete dimensions.
+typedef value sudokuGrid[GRID_SIZE + 1]; // A sudoku grid, and its '\0'.
 
 
 /*=== Function Declarations ===*/
@@ -40,11 +73,6 @@ typedef value sudokuGrid[GRID_SIZE];    // A sudoku grid of concrete dimensions.
 // Returns TRUE or FALSE based on success.
 int readGrid(sudokuGrid game, sudokuGrid inGrid);
 
-// Reads a grid from the console, while checking that values passed are
-// valid in a sudokuGrid and that the grid ends up the correct length.
-// Returns TRUE or FALSE based on success.
-int readGridFromConsole(sudokuGrid game);
-
 // Returns TRUE or FALSE depending if a grid has any BLANK characters in it.
 int isFull(sudokuGrid game);
 
@@ -66,18 +94,19 @@ int setCell(sudokuGrid game, cell targetCell, value moveValue);
 // Returns TRUE or FALSE based on success.
 int clearCell(sudokuGrid game, cell targetCell);
 
-// Checks that a grid is valid, then prints it to the terminal, formatted with
+// Checks that a grid is valid, then writes it into text, formatted with
 // spaces and newlines, to look like a sudoku grid, with sub-grid seperation.
-// Returns TRUE or FALSE based on success.
-int printGrid(sudokuGrid game);
+// Text must hold GRID_TEXT_SIZE chars; no '\0' is written.
+// Returns the number of chars written, or 0 if the grid is not valid.
+int formatGrid(sudokuGrid game, char *text);
 
 // Checks that a grid is valid, checking all its cells, and then if the grid
 // length is proper.
 // Returns TRUE or FALSE based on validity.
 int isValid(sudokuGrid game);
 
-// Checks that a value is valid, checking it against all values between
-// MIN_VALUE and MAX_VALUE, as well as checking BLANK.
+// Checks that a value is valid, checking it against the GRID_LENGTH values
+// from MIN_VALUE to MAX_VALUE, as well as checking BLANK.
 // Returns TRUE or FALSE based on validity.
 int isValidValue(value testValue);
 
@@ -0,0 +1,40 @@
+/*=== Include Guard ===*/
+#ifndef TABLES_H
+#define TABLES_H
+
+
+/*=== Includes ===*/
+
+#include "sudoku.h"     // To use cell, and the grid size.
+
+
+/*=== Defines ===*/
+
+#define GRID_UNITS (GRID_LENGTH * 3)    // The rows, columns and sub-grids.
+
+// The cells sharing a row, column or sub-grid with a cell, not counting
+// itself: the rest of its row and column, and the rest of its sub-grid
+// outside them (20 in a 9x9 grid).
+#define GRID_PEERS ((2 * (GRID_LENGTH - 1)) \
+        + ((GRID_SUB_LENGTH - 1) * (GRID_SUB_LENGTH - 1)))
+
+
+/*=== Tables ===*/
+
+// These are written out for every GRID_SUB_LENGTH by makeTables.c, into
+// tables.c, when building; the build's GRID_SUB_LENGTH picks its own.
+
+// The row, column and sub-grid of each cell, each from 0 to GRID_LENGTH - 1.
+// Sub-grids are numbered row by row, like cells.
+extern const cell cellRows[GRID_SIZE];
+extern const cell cellColumns[GRID_SIZE];
+extern const cell cellSubGrids[GRID_SIZE];
+
+// The peers of each cell, in order.
+extern const cell cellPeers[GRID_SIZE][GRID_PEERS];
+
+// The cells of each unit, in order: the first GRID_LENGTH units are the
+// rows, then the columns, then the sub-grids.
+extern const cell unitCells[GRID_UNITS][GRID_LENGTH];
+
+#endif
@@ -0,0 +1,1180 @@
+#include "testSolver.h" // To access included files and runSolverTests().
+#include "parallel.h"   // To test the parallel search.
+#include "dlx.h"        // To test the exact cover engine.
+#include "lockstep.h"   // To test the lockstep engine.
+#include "canon.h"      // To test canonical forms.
+#include "cache.h"      // To test the solution cache.
+#include "generate.h"   // To test the puzzle generator.
+#include "server.h"     // To test serving requests.
+#include "batch.h"      // To test solving batches.
+#include "difficulty.h" // To test the difficulty estimates.
+#include "libsudoku.h"  // To test the library's calls.
+#include <stdlib.h>     // To malloc() a search stack.
+#include <pthread.h>    // To serve two connections at once.
+#include <sched.h>      // To yield while a connection is being served.
+#include <unistd.h>     // To pipe() requests to the server.
+
+/*===========================================================================*/
+/*===== Testing Variables ===================================================*/
+/*===========================================================================*/
+
+/*======== Return Value Variable ===*/
+static int solverRv;
+
+
+/*======== Grid Variables ===*/
+
+// the grids below are written out for 9x9 builds; other sizes only run the
+// tests that don't need them.
+#if GRID_LENGTH == 9
+
+// the grid to be solved from grid_reference.txt, and how many solutions it has.
+#define PUZZLE_SOLUTIONS 5
+static sudokuGrid puzzleGrid =
+    ".51.......2..915...8..2..1..7.1.643.1..9.27..8627.3.5.7....82.521..7539..46.3.871";
+
+// a newspaper grid, solved by deduction alone.
+static sudokuGrid easyGrid =
+    "..3.2.6..9..3.5..1..18.64....81.29..7.......8..67.82....26.95..8..2.3..9..5.1.3..";
+
+// two '5's in the first row.
+static sudokuGrid clashGrid =
+    "55...............................................................................";
+
+// valid givens, but the first cell can hold no value.
+static sudokuGrid deadGrid =
+    ".123456789.......................................................................";
+
+// a grid from bench/hard.txt, which needs guessing.
+static sudokuGrid hardGrid =
+    "1....7.9..3..2...8..96..5....53..9...1..8...26....4...3......1..4......7..7...3..";
+
+// the state under test.
+static solverState testState;
+
+// transposes, swaps the first and last bands, the first two rows of the
+// middle band and the first two stacks, and reverses the values.
+static const gridTransform testTransform = {
+    TRUE,
+    {6, 7, 8, 4, 3, 5, 0, 1, 2},
+    {3, 4, 5, 0, 1, 2, 6, 7, 8},
+    {0, 9, 8, 7, 6, 5, 4, 3, 2, 1}
+};
+#endif
+
+
+
+/*============================================================================*/
+/*===== Static Test Functions. ===============================================*/
+/*============================================================================*/
+
+static void testEmptyGrid() {
+    solverState checkState;
+    sudokuGrid game;
+    searchOptions options;
+    int engine;
+
+    initOptions(&options);
+    memset(game, BLANK, GRID_SIZE);
+    game[GRID_SIZE] = '\0';
+
+    // Test every engine fills in an empty grid of any size, legally.
+    for (engine = ENGINE_BACKTRACK; engine <= ENGINE_LOCKSTEP; engine++) {
+        sudokuGrid solution;
+
+        options.engine = engine;
+        strcpy(solution, game);
+        solverRv = solveGrid(solution, &options);
+        assert(solverRv == SEARCH_SOLVED);
+        assert(getBlankCell(solution) == -1);
+        solverRv = initState(&checkState, solution);
+        assert(solverRv);
+    }
+}
+
+static void testGeneratePuzzle() {
+    generateOptions options;
+    solverState checkState;
+    sudokuGrid puzzle, solution, again;
+    unsigned long long seed = 1;
+    long count;
+    cell i;
+    int clues;
+
+    // Test a puzzle of any size is cut down to the clues asked for, with
+    // a single solution that keeps them.
+    initGenerateOptions(&options);
+    options.clues = GRID_SIZE / 2;
+    solverRv = generatePuzzle(puzzle, solution, &options, &seed);
+    assert(solverRv);
+    solverRv = initState(&checkState, solution);
+    assert(solverRv);
+    assert(getBlankCell(solution) == -1);
+
+    for (i = 0, clues = 0; i < GRID_SIZE; i++) {
+        if (puzzle[i] != BLANK) {
+            assert(puzzle[i] == solution[i]);
+            clues++;
+        }
+    }
+    assert(clues == GRID_SIZE / 2);
+
+    solverRv = countGrid(puzzle, 2, NULL, &count);
+    assert(solverRv == SEARCH_SOLVED);
+    assert(count == 1);
+
+
+    // Test the same seed gives the same puzzle.
+    seed = 1;
+    solverRv = generatePuzzle(again, NULL, &options, &seed);
+    assert(solverRv);
+    assert(strcmp(again, puzzle) == 0);
+
+#if GRID_LENGTH == 9
+    // Test every clue of a puzzle with as few as can be is needed, and
+    // that easy ones propagate to the solution and hard ones don't.
+    initGenerateOptions(&options);
+    for (options.difficulty = GENERATE_ANY;
+            options.difficulty <= GENERATE_HARD; options.difficulty++) {
+        solverRv = generatePuzzle(puzzle, solution, &options, &seed);
+        assert(solverRv);
+        solverRv = countGrid(puzzle, 2, NULL, &count);
+        assert(count == 1);
+
+        solverRv = initState(&checkState, puzzle);
+        assert(solverRv);
+        solverRv = propagateState(&checkState);
+        assert(solverRv);
+        if (options.difficulty == GENERATE_EASY)
+            assert(strcmp(checkState.game, solution) == 0);
+        else if (options.difficulty == GENERATE_HARD)
+            assert(getBlankCell(checkState.game) != -1);
+
+        for (i = 0; (options.difficulty == GENERATE_ANY) && (i < GRID_SIZE);
+                i++) {
+            if (puzzle[i] != BLANK) {
+                strcpy(again, puzzle);
+                again[i] = BLANK;
+                countGrid(again, 2, NULL, &count);
+                assert(count == 2);
+            }
+        }
+    }
+#endif
+}
+
+static void testEstimateExtremes() {
+    difficultyEstimate estimate;
+    sudokuGrid game;
+
+    memset(game, BLANK, GRID_SIZE);
+    game[GRID_SIZE] = '\0';
+
+    // Test an empty grid of any size is as hard as can be, and a full one
+    // as easy.
+    solverRv = estimateDifficulty(game, &estimate);
+    assert(solverRv);
+    assert((estimate.score == 100) && (estimate.level == DIFFICULTY_HARD));
+    assert((estimate.clues == 0) && (estimate.singles == 0));
+    assert(estimate.candidates == GRID_SIZE * GRID_LENGTH);
+
+    solverRv = solveGrid(game, NULL);
+    assert(solverRv == SEARCH_SOLVED);
+    solverRv = estimateDifficulty(game, &estimate);
+    assert(solverRv);
+    assert((estimate.score == 0) && (estimate.level == DIFFICULTY_EASY));
+    assert((estimate.clues == GRID_SIZE) && (estimate.confidence == 100));
+}
+
+static void testLubyTerm() {
+    static const long terms[] = {1, 1, 2, 1, 1, 2, 4, 1, 1, 2, 1, 1, 2, 4, 8, 1};
+    long i;
+
+    // Test the sequence starts as it should, and doubles at each 2^k - 1.
+    for (i = 0; i < (long) (sizeof(terms) / sizeof(terms[0])); i++)
+        assert(lubyTerm(i + 1) == terms[i]);
+    assert(lubyTerm(1023) == 512);
+    assert(lubyTerm(1024) == 1);
+}
+
+#if GRID_LENGTH == 9
+static void testInitState() {
+
+    // Test a grid with no clashes.
+    solverRv = initState(&testState, puzzleGrid);
+    assert(solverRv);
+    assert(strncmp(testState.game, puzzleGrid, GRID_SIZE) == 0);
+
+
+    // Test a grid whose givens clash.
+    solverRv = initState(&testState, clashGrid);
+    assert(!solverRv);
+}
+
+static void testGetCandidates() {
+    candidateMask candidates;
+
+    solverRv = initState(&testState, deadGrid);
+    assert(solverRv);
+
+    // Test a cell that every value is blocked from: '1' to '8' are in its
+    // row, and '9' is below it.
+    candidates = getCandidates(&testState, 0);
+    assert(candidates == 0);
+
+
+    // Test a cell sharing a sub-grid and column with givens ('1', '2', '9').
+    candidates = getCandidates(&testState, 18);
+    assert(candidates == (ALL_CANDIDATES & ~((1u << 0) | (1u << 1) | (1u << 8))));
+
+
+    // Test a cell sharing only a column with a given ('9').
+    candidates = getCandidates(&testState, 27);
+    assert(candidates == (ALL_CANDIDATES & ~(1u << 8)));
+}
+
+static void testStateSetClearCell() {
+
+    solverRv = initState(&testState, puzzleGrid);
+    assert(solverRv);
+
+    // Test setting a legal value, then the value is no longer a candidate.
+    solverRv = stateSetCell(&testState, 0, '3');
+    assert(solverRv);
+    assert(!(getCandidates(&testState, 2) & (1u << 2)));
+
+
+    // Test setting an illegal value, and setting a filled cell.
+    solverRv = stateSetCell(&testState, 2, '3');
+    assert(!solverRv);
+
+    solverRv = stateSetCell(&testState, 1, '9');
+    assert(!solverRv);
+
+
+    // Test clearing a cell, then the value is a candidate again.
+    solverRv = stateClearCell(&testState, 0);
+    assert(solverRv);
+    assert(getCandidates(&testState, 2) & (1u << 2));
+
+
+    // Test clearing a BLANK cell.
+    solverRv = stateClearCell(&testState, 0);
+    assert(!solverRv);
+}
+
+static void testPropagateState() {
+
+    // Test a grid that needs no guesses.
+    solverRv = initState(&testState, easyGrid);
+    assert(solverRv);
+    solverRv = propagateState(&testState);
+    assert(solverRv);
+    assert(getBlankCell(testState.game) == -1);
+
+
+    // Test a grid with a dead end.
+    solverRv = initState(&testState, deadGrid);
+    assert(solverRv);
+    solverRv = propagateState(&testState);
+    assert(!solverRv);
+}
+
+static void testChooseCell() {
+    searchOptions first, last;
+    cell chosen;
+
+    initOptions(&first);
+    first.branch = BRANCH_FIRST;
+    initOptions(&last);
+    last.tieBreak = TIE_LAST;
+
+    // Test branching on the first BLANK cell.
+    solverRv = initState(&testState, puzzleGrid);
+    assert(solverRv);
+    chosen = chooseCell(&testState, &first);
+    assert(chosen == 0);
+
+
+    // Test branching on the fewest candidates, which is a forced cell here.
+    chosen = chooseCell(&testState, NULL);
+    assert(testState.game[chosen] == BLANK);
+    assert(__builtin_popcount(getCandidates(&testState, chosen)) == 1);
+
+    chosen = chooseCell(&testState, &last);
+    assert(testState.game[chosen] == BLANK);
+    assert(__builtin_popcount(getCandidates(&testState, chosen)) == 1);
+
+
+    // Test a cell with no candidates is chosen, so the search prunes there.
+    solverRv = initState(&testState, deadGrid);
+    assert(solverRv);
+    chosen = chooseCell(&testState, &last);
+    assert(chosen == 0);
+}
+
+static void testSolveState() {
+    solverState checkState;
+    cell i;
+
+    // Test solving a grid with a solution.
+    solverRv = initState(&testState, puzzleGrid);
+    assert(solverRv);
+    solverRv = solveState(&testState);
+    assert(solverRv);
+
+    // the solution is full, keeps the givens, and has no clashes.
+    assert(getBlankCell(testState.game) == -1);
+    for (i = 0; i < GRID_SIZE; i++) {
+        if (puzzleGrid[i] != BLANK)
+            assert(testState.game[i] == puzzleGrid[i]);
+    }
+    solverRv = initState(&checkState, testState.game);
+    assert(solverRv);
+
+
+    // Test solving a grid with no solution, which is left untouched.
+    solverRv = initState(&testState, deadGrid);
+    assert(solverRv);
+    solverRv = solveState(&testState);
+    assert(!solverRv);
+    assert(strncmp(testState.game, deadGrid, GRID_SIZE) == 0);
+}
+
+
+static void testRunSearch() {
+    searchStack *search;
+    searchOptions options;
+    atomic_int cancel;
+    long nodes;
+
+    search = malloc(sizeof(*search));
+    assert(search);
+    initOptions(&options);
+    options.propagate = FALSE;
+
+    // Test the search gives up after a node, and can be resumed to the end.
+    solverRv = initState(&testState, easyGrid);
+    assert(solverRv);
+    initSearch(search, &testState, &options);
+
+    solverRv = runSearch(search, 1, 0);
+    assert(solverRv == SEARCH_GAVE_UP);
+    assert(search->stats.nodes == 1);
+
+    nodes = 1;
+    while ((solverRv = runSearch(search, 1, 0)) == SEARCH_GAVE_UP)
+        nodes++;
+    assert(solverRv == SEARCH_SOLVED);
+    assert(search->stats.nodes == nodes + 1);
+    assert(getBlankCell(search->state.game) == -1);
+
+    // a finished search stays finished.
+    solverRv = runSearch(search, 1, 0);
+    assert(solverRv == SEARCH_SOLVED);
+
+
+    // Test a node budget through searchState(), which leaves the state.
+    options.nodeLimit = 2;
+    solverRv = searchState(&testState, &options, &nodes);
+    assert(solverRv == SEARCH_GAVE_UP);
+    assert(nodes == 2);
+    assert(strcmp(testState.game, easyGrid) == 0);
+
+
+    // Test a deadline that has passed times out before the first node, and
+    // the search carries on once it is lifted.
+    options.nodeLimit = 0;
+    options.deadline = searchMicros() - 1;
+    initSearch(search, &testState, &options);
+    solverRv = runSearch(search, 0, 0);
+    assert(solverRv == SEARCH_TIMED_OUT);
+    assert(search->stats.nodes == 0);
+
+    search->options.deadline = 0;
+    solverRv = runSearch(search, 0, 0);
+    assert(solverRv == SEARCH_SOLVED);
+
+
+    // Test a cancel token times out the same way, through searchState().
+    atomic_store(&cancel, TRUE);
+    options.deadline = 0;
+    options.cancel = &cancel;
+    solverRv = searchState(&testState, &options, &nodes);
+    assert(solverRv == SEARCH_TIMED_OUT);
+    assert(nodes == 0);
+    assert(strcmp(testState.game, easyGrid) == 0);
+
+    free(search);
+}
+
+static void testSolveParallel() {
+    solverState checkState;
+    searchOptions options;
+    sudokuGrid empty;
+    atomic_int cancel;
+    threadPool *pool;
+
+    pool = createPool(2);
+    assert(pool);
+
+    // Test splitting a grid with a solution.
+    solverRv = initState(&testState, puzzleGrid);
+    assert(solverRv);
+    solverRv = solveParallel(&testState, pool, NULL);
+    assert(solverRv == SEARCH_SOLVED);
+    assert(getBlankCell(testState.game) == -1);
+    solverRv = initState(&checkState, testState.game);
+    assert(solverRv);
+
+
+    // Test splitting a grid with no solution, which is left untouched.
+    solverRv = initState(&testState, deadGrid);
+    assert(solverRv);
+    solverRv = solveParallel(&testState, pool, NULL);
+    assert(solverRv == SEARCH_NO_SOLUTION);
+    assert(strncmp(testState.game, deadGrid, GRID_SIZE) == 0);
+
+
+    // Test the caller's cancel is left alone by a split search that finds
+    // a solution, and calls off one it is set for.
+    initOptions(&options);
+    atomic_init(&cancel, FALSE);
+    options.cancel = &cancel;
+    solverRv = initState(&testState, puzzleGrid);
+    assert(solverRv);
+    solverRv = solveParallel(&testState, pool, &options);
+    assert((solverRv == SEARCH_SOLVED) && (!atomic_load(&cancel)));
+
+    memset(empty, BLANK, GRID_SIZE);
+    empty[GRID_SIZE] = '\0';
+    solverRv = initState(&testState, empty);
+    assert(solverRv);
+    atomic_store(&cancel, TRUE);
+    solverRv = solveParallel(&testState, pool, &options);
+    assert(solverRv == SEARCH_TIMED_OUT);
+    assert(getBlankCell(testState.game) == 0);
+
+    destroyPool(pool);
+}
+
+static void testRandomRestarts() {
+    sudokuGrid expected, game;
+    searchOptions options;
+    searchStats stats, again;
+
+    strcpy(expected, hardGrid);
+    solverRv = solveGrid(expected, NULL);
+    assert(solverRv == SEARCH_SOLVED);
+
+    // Test a seeded search without propagation, which has to guess a lot,
+    // finds the one solution, and searches the same way again from the
+    // same seed.
+    initOptions(&options);
+    options.propagate = FALSE;
+    options.seed = 7;
+    options.stats = &stats;
+    strcpy(game, hardGrid);
+    solverRv = solveGrid(game, &options);
+    assert(solverRv == SEARCH_SOLVED);
+    assert(strcmp(game, expected) == 0);
+
+    options.stats = &again;
+    strcpy(game, hardGrid);
+    solverRv = solveGrid(game, &options);
+    assert(solverRv == SEARCH_SOLVED);
+    assert(again.nodes == stats.nodes);
+
+
+    // Test restarting, many times over, still finds it, and again the same
+    // way; and that the node limit covers every run.
+    options.restartNodes = 20;
+    options.stats = &stats;
+    strcpy(game, hardGrid);
+    solverRv = solveGrid(game, &options);
+    assert(solverRv == SEARCH_SOLVED);
+    assert(strcmp(game, expected) == 0);
+    assert(stats.nodes > 20);
+
+    options.stats = &again;
+    strcpy(game, hardGrid);
+    solverRv = solveGrid(game, &options);
+    assert(solverRv == SEARCH_SOLVED);
+    assert(again.nodes == stats.nodes);
+
+    options.nodeLimit = 100;
+    strcpy(game, hardGrid);
+    solverRv = solveGrid(game, &options);
+    assert(solverRv == SEARCH_GAVE_UP);
+    assert((again.nodes > 20) && (again.nodes <= 100));
+    assert(strcmp(game, hardGrid) == 0);
+
+
+    // Test restarts still find there is no solution.
+    options.nodeLimit = 0;
+    strcpy(game, deadGrid);
+    solverRv = solveGrid(game, &options);
+    assert(solverRv == SEARCH_NO_SOLUTION);
+}
+
+static void testSolvePortfolio() {
+    sudokuGrid expected;
+    searchOptions options;
+    unsigned long long winner = 0;
+    atomic_int cancel;
+    threadPool *pool;
+
+    pool = createPool(3);
+    assert(pool);
+    strcpy(expected, hardGrid);
+    solverRv = solveGrid(expected, NULL);
+    assert(solverRv == SEARCH_SOLVED);
+
+    // Test racing seeded runs finds the solution, and that the winner's
+    // seed finds it alone.
+    initOptions(&options);
+    options.propagate = FALSE;
+    options.seed = 11;
+    options.restartNodes = 100;
+    solverRv = initState(&testState, hardGrid);
+    assert(solverRv);
+    solverRv = solvePortfolio(&testState, pool, &options, &winner);
+    assert(solverRv == SEARCH_SOLVED);
+    assert(strncmp(testState.game, expected, GRID_SIZE) == 0);
+
+    options.seed = winner;
+    solverRv = initState(&testState, hardGrid);
+    assert(solverRv);
+    solverRv = searchState(&testState, &options, NULL);
+    assert(solverRv == SEARCH_SOLVED);
+    assert(strncmp(testState.game, expected, GRID_SIZE) == 0);
+
+
+    // Test a race over a grid with no solution leaves it untouched.
+    solverRv = initState(&testState, deadGrid);
+    assert(solverRv);
+    solverRv = solvePortfolio(&testState, pool, &options, NULL);
+    assert(solverRv == SEARCH_NO_SOLUTION);
+    assert(strncmp(testState.game, deadGrid, GRID_SIZE) == 0);
+
+
+    // Test the caller's cancel calls off every run.
+    atomic_init(&cancel, TRUE);
+    options.cancel = &cancel;
+    solverRv = initState(&testState, hardGrid);
+    assert(solverRv);
+    solverRv = solvePortfolio(&testState, pool, &options, NULL);
+    assert(solverRv == SEARCH_TIMED_OUT);
+    assert(strncmp(testState.game, hardGrid, GRID_SIZE) == 0);
+
+    destroyPool(pool);
+}
+
+static void testDlx() {
+    sudokuGrid game;
+
+    // Test solving a grid with a solution, checked against the backtracker.
+    strcpy(game, easyGrid);
+    solverRv = dlxSolveGrid(game, NULL);
+    assert(solverRv == SEARCH_SOLVED);
+    solverRv = initState(&testState, easyGrid);
+    assert(solverRv);
+    solverRv = solveState(&testState);
+    assert(solverRv);
+    assert(strcmp(game, testState.game) == 0);
+
+
+    // Test grids with no solution, which are left untouched.
+    strcpy(game, deadGrid);
+    solverRv = dlxSolveGrid(game, NULL);
+    assert(solverRv == SEARCH_NO_SOLUTION);
+    assert(strcmp(game, deadGrid) == 0);
+
+    strcpy(game, clashGrid);
+    solverRv = dlxSolveGrid(game, NULL);
+    assert(solverRv == SEARCH_NO_SOLUTION);
+}
+
+static void testLockstep() {
+    sudokuGrid games[LOCKSTEP_LANES + 2], expected;
+    searchStats stats[LOCKSTEP_LANES + 2];
+    int statuses[LOCKSTEP_LANES + 2];
+    long count = LOCKSTEP_LANES + 2, i;
+
+    // Test a group and a bit of grids, mixing ones propagation solves, ones
+    // that need a guess, and ones without a solution, each get what a
+    // search of their own would.
+    for (i = 0; i < count; i++) {
+        const value *grid = easyGrid;
+
+        if (i % 4 == 1)
+            grid = hardGrid;
+        else if (i % 4 == 2)
+            grid = (i % 8 == 2) ? deadGrid : clashGrid;
+        strcpy(games[i], grid);
+    }
+    solveLockstep(games, count, NULL, statuses, stats);
+
+    for (i = 0; i < count; i++) {
+        if (i % 4 == 2) {
+            assert(statuses[i] == SEARCH_NO_SOLUTION);
+            assert(strcmp(games[i], (i % 8 == 2) ? deadGrid : clashGrid) == 0);
+            continue;
+        }
+
+        strcpy(expected, (i % 4 == 1) ? hardGrid : easyGrid);
+        solverRv = solveGrid(expected, NULL);
+        assert(solverRv == SEARCH_SOLVED);
+        assert(statuses[i] == SEARCH_SOLVED);
+        assert(strcmp(games[i], expected) == 0);
+        assert(stats[i].nodes >= 1);
+    }
+
+    // Test the lanes an easy grid is done in count as one node, and that a
+    // grid that needs a guess is searched past that.
+    assert(stats[0].nodes == 1);
+    assert(stats[1].nodes > 1);
+}
+
+static void testCountGrid() {
+    searchOptions options;
+    searchStats stats;
+    sudokuGrid game;
+    long count;
+    int engine;
+
+    initOptions(&options);
+
+    // Test both engines count the same.
+    for (engine = ENGINE_BACKTRACK; engine <= ENGINE_DLX; engine++) {
+        options.engine = engine;
+        options.nodeLimit = 0;
+
+        // Test a grid with one solution.
+        solverRv = countGrid(easyGrid, 0, &options, &count);
+        assert(solverRv == SEARCH_SOLVED);
+        assert(count == 1);
+
+
+        // Test a grid with more than one, all of them and up to a limit.
+        solverRv = countGrid(puzzleGrid, 0, &options, &count);
+        assert(solverRv == SEARCH_SOLVED);
+        assert(count == PUZZLE_SOLUTIONS);
+
+        solverRv = countGrid(puzzleGrid, 2, &options, &count);
+        assert(solverRv == SEARCH_SOLVED);
+        assert(count == 2);
+
+
+        // Test a grid with none.
+        solverRv = countGrid(deadGrid, 0, &options, &count);
+        assert(solverRv == SEARCH_NO_SOLUTION);
+        assert(count == 0);
+
+
+        // Test running out of budget part way through.
+        options.nodeLimit = 1;
+        solverRv = countGrid(puzzleGrid, 0, &options, &count);
+        assert(solverRv == SEARCH_GAVE_UP);
+
+
+        // Test a limit of N nodes searches exactly N on either engine.
+        options.nodeLimit = 50;
+        options.stats = &stats;
+        strcpy(game, hardGrid);
+        solverRv = solveGrid(game, &options);
+        assert(solverRv == SEARCH_GAVE_UP);
+        assert(stats.nodes == 50);
+        options.stats = NULL;
+
+
+        // Test running out of time is told apart from running out of nodes.
+        options.nodeLimit = 0;
+        options.deadline = searchMicros() - 1;
+        solverRv = countGrid(puzzleGrid, 0, &options, &count);
+        assert(solverRv == SEARCH_TIMED_OUT);
+        options.deadline = 0;
+    }
+}
+
+static void testSearchStats() {
+    searchOptions options;
+    searchStats stats, total = {0};
+    sudokuGrid game;
+    int engine;
+
+    initOptions(&options);
+    options.stats = &stats;
+
+    // Test both engines count their nodes, and more when built to.
+    for (engine = ENGINE_BACKTRACK; engine <= ENGINE_DLX; engine++) {
+        options.engine = engine;
+
+        strcpy(game, puzzleGrid);
+        solverRv = solveGrid(game, &options);
+        assert(solverRv == SEARCH_SOLVED);
+        assert(stats.nodes > 0);
+#ifdef SUDOKU_STATS
+        assert(stats.maxDepth > 0);
+#endif
+        addStats(&total, &stats);
+        addStats(&total, &stats);
+        assert(total.nodes >= 2 * stats.nodes);
+
+
+        // Test clashing givens are no search at all.
+        strcpy(game, clashGrid);
+        solverRv = solveGrid(game, &options);
+        assert(solverRv == SEARCH_NO_SOLUTION);
+        assert(stats.nodes == 0);
+    }
+}
+
+static void testCanonicalGrid() {
+    sudokuGrid moved, canonical, movedCanonical, back;
+    gridTransform transform, movedTransform;
+
+    // Test a grid and a transform of it have the same canonical form, and
+    // the transforms to it undo.
+    applyTransform(&testTransform, easyGrid, moved);
+    assert(strcmp(moved, easyGrid) != 0);
+
+    solverRv = canonicalGrid(easyGrid, canonical, &transform);
+    assert(solverRv);
+    solverRv = canonicalGrid(moved, movedCanonical, &movedTransform);
+    assert(solverRv);
+    assert(strcmp(canonical, movedCanonical) == 0);
+
+    invertTransform(&transform, canonical, back);
+    assert(strcmp(back, easyGrid) == 0);
+    invertTransform(&movedTransform, canonical, back);
+    assert(strcmp(back, moved) == 0);
+
+
+    // Test the canonical form is no bigger than the grid, BLANKs first.
+    assert(strcmp(canonical, easyGrid) <= 0);
+}
+
+static void testSolutionCache() {
+    solutionCache *cache;
+    cacheCounts counts;
+    searchOptions options;
+    solverState checkState;
+    sudokuGrid game, givens;
+    cell i;
+
+    initOptions(&options);
+    cache = createCache(1);
+    assert(cache);
+    assert(!createCache(0));
+
+    // Test a grid misses, then a transform of it hits with its own
+    // solution.
+    strcpy(game, easyGrid);
+    solverRv = solveCached(cache, game, &options);
+    assert(solverRv == SEARCH_SOLVED);
+
+    applyTransform(&testTransform, easyGrid, givens);
+    strcpy(game, givens);
+    solverRv = solveCached(cache, game, &options);
+    assert(solverRv == SEARCH_SOLVED);
+    assert(getBlankCell(game) == -1);
+    solverRv = initState(&checkState, game);
+    assert(solverRv);
+
+    for (i = 0; i < GRID_SIZE; i++) {
+        if (givens[i] != BLANK)
+            assert(game[i] == givens[i]);
+    }
+
+
+    // Test a grid with no solution is kept, dropping the oldest entry.
+    strcpy(game, deadGrid);
+    solverRv = solveCached(cache, game, &options);
+    assert(solverRv == SEARCH_NO_SOLUTION);
+    solverRv = solveCached(cache, game, &options);
+    assert(solverRv == SEARCH_NO_SOLUTION);
+    assert(strcmp(game, deadGrid) == 0);
+
+
+    // Test no options take the defaults, on a hit and on a miss, as
+    // solveGrid() does.
+    solverRv = solveCached(cache, game, NULL);
+    assert(solverRv == SEARCH_NO_SOLUTION);
+    strcpy(game, easyGrid);
+    solverRv = solveCached(cache, game, NULL);
+    assert(solverRv == SEARCH_SOLVED);
+    assert(getBlankCell(game) == -1);
+
+    getCacheCounts(cache, &counts);
+    assert(counts.hits == 3);
+    assert(counts.misses == 3);
+    assert(counts.evictions == 2);
+    assert(counts.entries == 1);
+
+    destroyCache(cache);
+}
+
+static void testServeConnection() {
+    serverOptions options = {0};
+    sudokuGrid solution;
+    char requests[1024], line[256], *got;
+    FILE *out;
+    int fds[2], hintCell, length;
+    char hintValue;
+
+    initOptions(&options.search);
+    strcpy(solution, easyGrid);
+    solverRv = solveGrid(solution, NULL);
+    assert(solverRv == SEARCH_SOLVED);
+
+    // Test pipelined requests are answered in order, a line each, and
+    // nothing after a quit.
+    length = snprintf(requests, sizeof(requests),
+            "solve %s\ncount %s 0\nhint %s\nsolve %s\nbogus\n\n"
+            "stats\nquit\nsolve %s\n", easyGrid, puzzleGrid, easyGrid,
+            deadGrid, easyGrid);
+    solverRv = pipe(fds);
+    assert(solverRv == 0);
+    solverRv = write(fds[1], requests, length);
+    assert(solverRv == length);
+    close(fds[1]);
+
+    out = tmpfile();
+    assert(out);
+    serveConnection(fds[0], out, &options, 1);
+    close(fds[0]);
+    rewind(out);
+
+    got = fgets(line, sizeof(line), out);
+    assert(got);
+    assert(strncmp(line, solution, GRID_SIZE) == 0);
+    got = fgets(line, sizeof(line), out);
+    assert(got);
+    assert(strcmp(line, "5\n") == 0);
+
+    got = fgets(line, sizeof(line), out);
+    assert(got);
+    solverRv = sscanf(line, "%d %c", &hintCell, &hintValue);
+    assert(solverRv == 2);
+    assert(easyGrid[hintCell] == BLANK);
+    assert(solution[hintCell] == hintValue);
+
+    got = fgets(line, sizeof(line), out);
+    assert(got);
+    assert(strcmp(line, NO_SOLUTION_LINE "\n") == 0);
+    got = fgets(line, sizeof(line), out);
+    assert(got);
+    assert(strncmp(line, INVALID_LINE " ", strlen(INVALID_LINE) + 1) == 0);
+    got = fgets(line, sizeof(line), out);
+    assert(got);
+    assert(strncmp(line, "stats requests=5 ", 17) == 0);
+    got = fgets(line, sizeof(line), out);
+    assert(!got);
+
+    fclose(out);
+}
+
+// A connection served on a thread of its own, and whether it is over.
+typedef struct {
+    int in;
+    FILE *out;
+    const serverOptions *options;
+    atomic_int over;
+} testConnection;
+
+// Serves a testConnection, and says when it is over.
+static void *serveTestConnection(void *context) {
+    testConnection *connection = context;
+
+    serveConnection(connection->in, connection->out, connection->options,
+            1);
+    atomic_store(&connection->over, TRUE);
+    return NULL;
+}
+
+static void testServeConnections() {
+    serverOptions options = {0};
+    testConnection slow;
+    pthread_t thread;
+    sudokuGrid empty, solution;
+    char request[256], line[256], *got;
+    FILE *out;
+    atomic_int stop;
+    int fds[2], slowFds[2], length;
+
+    initOptions(&options.search);
+    atomic_init(&stop, FALSE);
+    options.search.cancel = &stop;
+    options.pool = createPool(2);
+    assert(options.pool);
+    memset(empty, BLANK, GRID_SIZE);
+    empty[GRID_SIZE] = '\0';
+    strcpy(solution, easyGrid);
+    solverRv = solveGrid(solution, NULL);
+    assert(solverRv == SEARCH_SOLVED);
+
+    // Test a connection counting the solutions of an empty grid, which
+    // only ends when it is cancelled, doesn't hold up another's quick solve
+    // on the same pool: the solve is answered while the count still runs.
+    solverRv = pipe(slowFds);
+    assert(solverRv == 0);
+    length = snprintf(request, sizeof(request), "count %s 0\n", empty);
+    solverRv = write(slowFds[1], request, length);
+    assert(solverRv == length);
+    close(slowFds[1]);
+
+    slow.in = slowFds[0];
+    slow.out = tmpfile();
+    slow.options = &options;
+    atomic_init(&slow.over, FALSE);
+    assert(slow.out);
+    solverRv = pthread_create(&thread, NULL, serveTestConnection, &slow);
+    assert(solverRv == 0);
+    while (serverRequestsRunning(options.pool) == 0)
+        sched_yield();
+
+    solverRv = pipe(fds);
+    assert(solverRv == 0);
+    length = snprintf(request, sizeof(request), "solve %s\n", easyGrid);
+    solverRv = write(fds[1], request, length);
+    assert(solverRv == length);
+    close(fds[1]);
+
+    out = tmpfile();
+    assert(out);
+    serveConnection(fds[0], out, &options, 2);
+    assert(!atomic_load(&slow.over));
+    solverRv = serverRequestsRunning(options.pool);
+    assert(solverRv == 1);
+    close(fds[0]);
+
+    rewind(out);
+    got = fgets(line, sizeof(line), out);
+    assert(got);
+    assert(strncmp(line, solution, GRID_SIZE) == 0);
+    fclose(out);
+
+    // Test the count, cancelled, is answered as out of time.
+    atomic_store(&stop, TRUE);
+    pthread_join(thread, NULL);
+    assert(atomic_load(&slow.over));
+    close(slowFds[0]);
+    rewind(slow.out);
+    got = fgets(line, sizeof(line), slow.out);
+    assert(got);
+    assert(strncmp(line, TIMED_OUT_LINE " ", strlen(TIMED_OUT_LINE) + 1)
+            == 0);
+    fclose(slow.out);
+
+    destroyPool(options.pool);
+}
+
+static void testSolveBatch() {
+    batchOptions options = {0};
+    batchTotals totals, pooledTotals;
+    sudokuGrid solution;
+    char line[256], pooledLine[256], *got;
+    FILE *in, *out, *pooledOut;
+    long i, lines = 0;
+
+    initOptions(&options.search);
+    strcpy(solution, easyGrid);
+    solverRv = solveGrid(solution, NULL);
+    assert(solverRv == SEARCH_SOLVED);
+
+    in = tmpfile();
+    out = tmpfile();
+    pooledOut = tmpfile();
+    assert((in) && (out) && (pooledOut));
+    for (i = 0; i < 1000; i++) {
+        fprintf(in, "%s\n%s\n\nbogus\n", easyGrid, deadGrid);
+        lines += 3;
+    }
+
+    // Test a batch solved on this thread writes a line per grid, in order.
+    rewind(in);
+    solveBatch(in, out, &options, &totals);
+    assert(totals.puzzles == lines);
+    assert(totals.solved == 1000);
+    assert(totals.unsolvable == 1000);
+    assert(totals.invalid == 1000);
+    assert(totals.writeError == 0);
+
+
+    // Test a batch pipelined on a pool, through more chunks than are in
+    // flight at once, writes the same lines in the same order.
+    options.pool = createPool(3);
+    assert(options.pool);
+    rewind(in);
+    solveBatch(in, pooledOut, &options, &pooledTotals);
+    assert(pooledTotals.puzzles == lines);
+    assert(pooledTotals.solved == totals.solved);
+    assert(pooledTotals.unsolvable == totals.unsolvable);
+    assert(pooledTotals.invalid == totals.invalid);
+
+    rewind(out);
+    rewind(pooledOut);
+    for (i = 0; i < lines; i++) {
+        got = fgets(line, sizeof(line), out);
+        assert(got);
+        got = fgets(pooledLine, sizeof(pooledLine), pooledOut);
+        assert(got);
+        assert(strcmp(line, pooledLine) == 0);
+        if (i % 3 == 0)
+            assert(strncmp(line, solution, GRID_SIZE) == 0);
+    }
+    got = fgets(line, sizeof(line), out);
+    assert(!got);
+    got = fgets(pooledLine, sizeof(pooledLine), pooledOut);
+    assert(!got);
+
+
+    // Test an empty batch writes nothing.
+    fclose(in);
+    fclose(pooledOut);
+    in = tmpfile();
+    pooledOut = tmpfile();
+    assert((in) && (pooledOut));
+    solveBatch(in, pooledOut, &options, &pooledTotals);
+    assert(pooledTotals.puzzles == 0);
+    assert(lseek(fileno(pooledOut), 0, SEEK_END) == 0);
+
+    destroyPool(options.pool);
+    fclose(in);
+    fclose(out);
+    fclose(pooledOut);
+}
+
+static void testEstimateDifficulty() {
+    difficultyEstimate estimate;
+
+    // Test a newspaper grid looks easy, and a grid that needs guessing
+    // hard, both surely.
+    solverRv = estimateDifficulty(easyGrid, &estimate);
+    assert(solverRv);
+    assert((estimate.level == DIFFICULTY_EASY) && (estimate.confidence > 90));
+    assert(estimate.singles > 0);
+    solverRv = estimateDifficulty(hardGrid, &estimate);
+    assert(solverRv);
+    assert((estimate.level == DIFFICULTY_HARD) && (estimate.confidence > 90));
+    assert(estimate.score > DIFFICULTY_HARD_SCORE);
+
+    // Test a dead end is easy, since its search stops at once, and that
+    // clashing givens aren't estimated.
+    solverRv = estimateDifficulty(deadGrid, &estimate);
+    assert((solverRv) && (estimate.deadEnd));
+    assert((estimate.score == 0) && (estimate.confidence == 100));
+    solverRv = estimateDifficulty(clashGrid, &estimate);
+    assert(!solverRv);
+}
+
+static void testLibrary() {
+    sudokuResult result;
+    searchOptions options;
+    sudokuGrid solution;
+
+    // Test a result laid out otherwise is left alone but for its status.
+    result.layout = SUDOKU_LAYOUT ^ 1;
+    result.count = -1;
+    solverRv = sudokuSolve(easyGrid, GRID_SIZE, NULL, &result);
+    assert((solverRv == SUDOKU_MISMATCH) && (result.status == SUDOKU_MISMATCH));
+    assert(result.count == -1);
+    solverRv = sudokuValidate(easyGrid, GRID_SIZE, &result);
+    assert(solverRv == SUDOKU_MISMATCH);
+    result.layout = SUDOKU_LAYOUT;
+
+    // Test validating says why text isn't a grid, or which givens clash.
+    solverRv = sudokuValidate(easyGrid, GRID_SIZE, &result);
+    assert((solverRv == SUDOKU_VALID) && (result.status == SUDOKU_VALID));
+    assert(result.badCell == -1);
+    solverRv = sudokuValidate(easyGrid, GRID_SIZE - 1, &result);
+    assert(solverRv == SUDOKU_INVALID);
+    assert(result.length == GRID_SIZE - 1);
+    strcpy(solution, easyGrid);
+    solution[4] = 'x';
+    solverRv = sudokuValidate(solution, GRID_SIZE, &result);
+    assert((solverRv == SUDOKU_INVALID) && (result.badCell == 4));
+    solverRv = sudokuValidate(clashGrid, GRID_SIZE, &result);
+    assert((solverRv == SUDOKU_CLASH) && (result.badCell == 1));
+
+    // Test solving fills in the solution and the stats, without touching
+    // the text, and that a bad grid isn't searched.
+    strcpy(solution, easyGrid);
+    solverRv = solveGrid(solution, NULL);
+    assert(solverRv == SEARCH_SOLVED);
+    solverRv = sudokuSolve(easyGrid, GRID_SIZE, NULL, &result);
+    assert(solverRv == SEARCH_SOLVED);
+    assert(strcmp(result.solution, solution) == 0);
+    assert((result.count == 1) && (result.stats.nodes >= 1));
+    assert(easyGrid[0] == BLANK);
+    solverRv = sudokuSolve(deadGrid, GRID_SIZE, NULL, &result);
+    assert((solverRv == SEARCH_NO_SOLUTION) && (result.count == 0));
+    solverRv = sudokuSolve(clashGrid, GRID_SIZE, NULL, &result);
+    assert((solverRv == SUDOKU_CLASH) && (result.stats.nodes == 0));
+
+    // Test estimating leaves the search alone.
+    solverRv = sudokuEstimate(hardGrid, GRID_SIZE, &result);
+    assert((solverRv == SUDOKU_VALID) && (result.stats.nodes == 0));
+    assert(result.estimate.level == DIFFICULTY_HARD);
+    solverRv = sudokuEstimate(clashGrid, GRID_SIZE, &result);
+    assert(solverRv == SUDOKU_CLASH);
+
+    // Test counting, with either engine and with a budget.
+    initOptions(&options);
+    options.engine = ENGINE_DLX;
+    solverRv = sudokuCount(puzzleGrid, GRID_SIZE, 0, &options, &result);
+    assert((solverRv == SEARCH_SOLVED) && (result.count == PUZZLE_SOLUTIONS));
+    solverRv = sudokuCount(puzzleGrid, GRID_SIZE, 2, NULL, &result);
+    assert((solverRv == SEARCH_SOLVED) && (result.count == 2));
+    options.engine = ENGINE_BACKTRACK;
+    options.propagate = FALSE;
+    options.nodeLimit = 1;
+    solverRv = sudokuCount(puzzleGrid, GRID_SIZE, 0, &options, &result);
+    assert((solverRv == SEARCH_GAVE_UP) && (result.stats.nodes >= 1));
+}
+#endif
+
+
+/*============================================================================*/
+/*===== Run Tests Function. ==================================================*/
+/*============================================================================*/
+
+void runSolverTests() {
+
+    // Announce what is being tested.
+    printf("Testing solver.c ...");
+
+    // Run tests.
+    testEmptyGrid();
+    testGeneratePuzzle();
+    testEstimateExtremes();
+    testLubyTerm();
+#if GRID_LENGTH == 9
+    testInitState();
+    testGetCandidates();
+    testStateSetClearCell();
+    testPropagateState();
+    testChooseCell();
+    testSolveState();
+    testRunSearch();
+    testSolveParallel();
+    testRandomRestarts();
+    testSolvePortfolio();
+    testDlx();
+    testLockstep();
+    testCountGrid();
+    testSearchStats();
+    testCanonicalGrid();
+    testSolutionCache();
+    testServeConnection();
+    testServeConnections();
+    testSolveBatch();
+    testEstimateDifficulty();
+    testLibrary();
+#endif
+
+
+    // Print that all tests passed.
+    printf("All tests passed!");
+}
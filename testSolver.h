@@ -0,0 +1,19 @@
+/*=== Include Guard ===*/
+#ifndef TESTSOLVER_H
+#define TESTSOLVER_H
+
+
+/*=== Includes ===*/
+
+#include "solver.h"     // To use solver functions.
+#include <assert.h>     // To test everything.
+#include <string.h>     // To do string operations in tests.
+
+
+/*=== Function Declarations ===*/
+
+// Runs all unit tests for solver.c, and will abort the program if a test
+// does not pass. All tests are defined as static in "testSolver.c".
+void runSolverTests();
+
+#endif
@@ -1,20 +1,31 @@
 #include "testSudoku.h" // To access included files and runTests() definition.
+#include "console.h"    // To test printing grids.
+#include "tables.h"     // To test the lookup tables.
+#include "scan.h"       // To test checking and parsing grids.
+#include "pack.h"       // To test packing grids.
+#include "output.h"     // To test writing output a buffer at a time.
+#include "ring.h"       // To test the lock-free rings.
+#include <pthread.h>    // To pop a ring on several threads at once.
 
 /*===========================================================================*/
 /*===== Testing Variables ===================================================*/
 /*===========================================================================*/
 
 /*======== Return Value Variable ===*/
-int rv;
+static int rv;
 
 
 /*======== Grid Variables ===*/
 
+// the grids below are written out for 9x9 builds; other sizes only run the
+// tests that don't need them.
+#if GRID_LENGTH == 9
+
 // an empty grid.
-sudokuGrid testGrid;
+static sudokuGrid testGrid;
 
 // for checking legality of moves with invalidating '1's.
-sudokuGrid validGrid = {
+static sudokuGrid validGrid = {
     '.','.','.',   '.','.','.',   '.','.','1',
     '1','.','.',   '.','1','.',   '.','.','.',
     '.','.','.',   '.','.','.',   '.','.','.',
@@ -29,7 +40,7 @@ sudokuGrid validGrid = {
 };
 
 // filled with valid chars and no blanks.
-sudokuGrid validFullGrid = {
+static sudokuGrid validFullGrid = {
     '1','2','3',   '4','5','6',   '7','8','9',
     '1','2','3',   '4','5','6',   '7','8','9',
     '1','2','3',   '4','5','6',   '7','8','9',
@@ -44,7 +55,7 @@ sudokuGrid validFullGrid = {
 };
 
 // has bad char 'X'.
-sudokuGrid badCharGrid = {
+static sudokuGrid badCharGrid = {
     '1','2','3',   '4','5','6',   '7','X','9',
     '1','2','3',   '4','5','6',   '7','X','9',
     '1','2','3',   '4','5','6',   '7','X','9',
@@ -59,7 +70,7 @@ sudokuGrid badCharGrid = {
 };
 
 // too short.
-sudokuGrid badLengthGrid = {
+static sudokuGrid badLengthGrid = {
     '1','2','3',   '4','5','6',   '7','8','9',
     '1','2','3',   '4','5','6',   '7','8','9',
     '1','2','3',   '4','5','6',   '7','8','9',
@@ -73,12 +84,279 @@ sudokuGrid badLengthGrid = {
     '1','2','3',   '4','5','6',   '7',
 };
 
+#endif
+
 
 
 /*============================================================================*/
 /*===== Static Test Functions. ===============================================*/
 /*============================================================================*/
 
+static void testIsValidValue() {
+    int i;
+
+    // Test every value maps to its offset and back.
+    for (i = 0; i < GRID_LENGTH; i++) {
+        rv = isValidValue(INDEX_VALUE(i));
+        assert(rv);
+        assert(VALUE_INDEX(INDEX_VALUE(i)) == i);
+    }
+    assert(INDEX_VALUE(GRID_LENGTH - 1) == MAX_VALUE);
+
+
+    // Test values outside the alphabet, and BLANK.
+    rv = isValidValue(MIN_VALUE - 1);
+    assert(!rv);
+
+    rv = isValidValue(MAX_VALUE + 1);
+    assert(!rv);
+
+    rv = isValidValue(':'); // Between '9' and 'A'.
+    assert(!rv);
+
+    rv = isValidValue(BLANK);
+    assert(rv);
+}
+
+static void testTables() {
+    cell i, j;
+    int k;
+
+    // Test every peer shares a column, row or sub-grid with its cell.
+    for (i = 0; i < GRID_SIZE; i++) {
+        for (k = 0; k < GRID_PEERS; k++) {
+            j = cellPeers[i][k];
+            assert(j != i);
+            assert((cellRows[j] == cellRows[i])
+                    || (cellColumns[j] == cellColumns[i])
+                    || (cellSubGrids[j] == cellSubGrids[i]));
+        }
+    }
+
+
+    // Test the cells of each unit are in it.
+    for (k = 0; k < GRID_LENGTH; k++) {
+        for (i = 0; i < GRID_LENGTH; i++) {
+            assert(cellRows[unitCells[k][i]] == k);
+            assert(cellColumns[unitCells[GRID_LENGTH + k][i]] == k);
+            assert(cellSubGrids[unitCells[(GRID_LENGTH * 2) + k][i]] == k);
+        }
+    }
+}
+
+static void testScanGrid() {
+    static const value badChars[] = { MIN_VALUE - 1, MAX_VALUE + 1, ':', '@',
+        ' ', (value) 0x80 };
+    sudokuGrid grid, bad;
+    gridScan scan;
+    cell i, j;
+    int k;
+
+    // every value in turn, with a BLANK in every 7th cell.
+    for (i = 0; i < GRID_SIZE; i++)
+        grid[i] = (i % 7) ? INDEX_VALUE(i % GRID_LENGTH) : BLANK;
+    grid[GRID_SIZE] = '\0';
+
+    // Test a grid parses to its digits and blanks.
+    rv = scanGrid(grid, GRID_SIZE, &scan);
+    assert(rv);
+    assert(scan.badCell == -1);
+    for (i = 0; i < GRID_SIZE; i++) {
+        int blank = (scan.blanks[i / 64] >> (i % 64)) & 1;
+
+        assert(blank == (grid[i] == BLANK));
+        assert(scan.digits[i] == ((blank) ? 0 : VALUE_INDEX(grid[i]) + 1));
+    }
+
+
+    // Test a bad char is found in every cell, whether it is checked in a
+    // chunk or one at a time, and only the first of two is given.
+    for (k = 0; k < (int) sizeof(badChars); k++) {
+        for (i = 0; i < GRID_SIZE; i++) {
+            j = i + ((GRID_SIZE - 1 - i) / 2);
+
+            memcpy(bad, grid, sizeof(bad));
+            bad[j] = 'z';
+            bad[i] = badChars[k];
+            assert(findBadCell(bad) == i);
+
+            rv = scanGrid(bad, GRID_SIZE, &scan);
+            assert(!rv);
+            assert(scan.badCell == i);
+        }
+    }
+
+
+    // Test a line of the wrong length isn't a grid.
+    rv = scanGrid(grid, GRID_SIZE - 1, &scan);
+    assert(!rv);
+    assert(scan.length == GRID_SIZE - 1);
+    assert(scan.badCell == -1);
+}
+
+static void testPackGrid() {
+    unsigned char record[PACK_RECORD], fromDigits[PACK_RECORD];
+    sudokuGrid grid, unpacked;
+    gridScan scan;
+    cell i;
+
+    for (i = 0; i < GRID_SIZE; i++)
+        grid[i] = (i % 7) ? INDEX_VALUE(i % GRID_LENGTH) : BLANK;
+    grid[GRID_SIZE] = '\0';
+
+    // Test a grid packs the same from its values and its digit codes, and
+    // unpacks to itself.
+    packGrid(grid, record);
+    rv = scanGrid(grid, GRID_SIZE, &scan);
+    assert(rv);
+    packDigits(scan.digits, fromDigits);
+    assert(memcmp(record, fromDigits, PACK_RECORD) == 0);
+
+    rv = unpackGrid(record, unpacked);
+    assert(rv == -1);
+    assert(strcmp(unpacked, grid) == 0);
+
+
+    // Test an empty record is an empty grid.
+    memset(record, 0, sizeof(record));
+    rv = unpackGrid(record, unpacked);
+    assert(rv == -1);
+    for (i = 0; i < GRID_SIZE; i++)
+        assert(unpacked[i] == BLANK);
+
+
+    // Test a code past the values is found, and unpacked as invalid.
+    record[1] = (unsigned char) (((1 << PACK_BITS) - 1) << (8 - PACK_BITS));
+    rv = unpackGrid(record, unpacked);
+    assert(rv == (16 - PACK_BITS) / PACK_BITS);
+    assert(!isValid(unpacked));
+}
+
+static void testOutputWriter() {
+    outputWriter writer;
+    char big[GRID_SIZE * 64], text[sizeof(big) + 64];
+    FILE *file;
+    size_t length;
+
+    // Test the formats are known by name.
+    assert(parseOutputFormat("lines") == OUTPUT_LINES);
+    assert(parseOutputFormat("json") == OUTPUT_JSON);
+    assert(parseOutputFormat("packed") == OUTPUT_PACKED);
+    assert(parseOutputFormat("pretty") == OUTPUT_PRETTY);
+    assert(parseOutputFormat("csv") == OUTPUT_UNKNOWN);
+
+
+    // Test output too big for the smallest buffer comes out in order, around
+    // what is put, printed and reserved before and after it, and that it
+    // can be written over.
+    file = tmpfile();
+    assert(file);
+    rv = openWriter(&writer, fileno(file), 1);
+    assert(rv);
+    assert(writer.size >= outputEntryBytes(OUTPUT_JSON));
+
+    memset(big, 'x', sizeof(big));
+    putOutput(&writer, "ab", 2);
+    printOutput(&writer, "%d,", 42);
+    putOutput(&writer, big, sizeof(big));
+    memcpy(reserveOutput(&writer, 3), "end", 3);
+    writer.used += 3;
+    rv = rewriteOutput(&writer, 1, "B", 1);
+    assert(rv);
+    rv = closeWriter(&writer);
+    assert(rv);
+
+    rewind(file);
+    length = fread(text, 1, sizeof(text), file);
+    assert(length == 2 + 3 + sizeof(big) + 3);
+    assert(memcmp(text, "aB42,", 5) == 0);
+    assert(memcmp(&text[5], big, sizeof(big)) == 0);
+    assert(memcmp(&text[length - 3], "end", 3) == 0);
+    fclose(file);
+
+
+    // Test a write that fails is kept, and the rest dropped.
+    rv = openWriter(&writer, -1, 0);
+    assert(rv);
+    putOutput(&writer, "ab", 2);
+    rv = flushWriter(&writer);
+    assert(!rv);
+    assert(writer.error != 0);
+    rv = closeWriter(&writer);
+    assert(!rv);
+}
+
+// The values a thread popped from a ring until it popped -1, and their sum.
+typedef struct {
+    longRing *ring;
+    long count;
+    long sum;
+} ringConsumer;
+
+// Pops a ringConsumer's ring until it pops -1.
+static void *consumeRing(void *context) {
+    ringConsumer *consumer = context;
+    long value;
+
+    while ((value = popRing(consumer->ring)) >= 0) {
+        consumer->count++;
+        consumer->sum += value;
+    }
+
+    return NULL;
+}
+
+static void testRing() {
+    ringConsumer consumers[3];
+    pthread_t threads[3];
+    longRing ring;
+    long i, count, sum;
+
+    // Test values come out in the order they went in, around the ring
+    // more than once, from a capacity rounded up to a power of two.
+    rv = initRing(&ring, 3);
+    assert(rv);
+    assert(ring.capacity == 4);
+    for (i = 0; i < 10; i++) {
+        pushRing(&ring, i);
+        pushRing(&ring, i + 100);
+        rv = popRing(&ring);
+        assert(rv == i);
+        rv = popRing(&ring);
+        assert(rv == i + 100);
+    }
+
+
+    // Test a full ring makes the pusher wait, and every value is popped
+    // exactly once by threads popping it at once.
+    for (i = 0; i < 3; i++) {
+        consumers[i].ring = &ring;
+        consumers[i].count = 0;
+        consumers[i].sum = 0;
+        rv = pthread_create(&threads[i], NULL, consumeRing, &consumers[i]);
+        assert(rv == 0);
+    }
+
+    for (i = 0; i < 10000; i++)
+        pushRing(&ring, i);
+    for (i = 0; i < 3; i++)
+        pushRing(&ring, -1);
+
+    count = 0;
+    sum = 0;
+    for (i = 0; i < 3; i++) {
+        pthread_join(threads[i], NULL);
+        count += consumers[i].count;
+        sum += consumers[i].sum;
+    }
+    assert(count == 10000);
+    assert(sum == 10000L * 9999 / 2);
+
+    destroyRing(&ring);
+}
+
+#if GRID_LENGTH == 9
+
 static void testReadGrid() {
 
     // Test reading with a valid grid.
@@ -189,6 +467,18 @@ static void testClearCell() {
 }
 
 static void testPrintGrid() {
+    char text[GRID_TEXT_SIZE];
+
+    // Test formatting a grid lays each row out with its sub-grids apart,
+    // and a blank line between bands.
+    rv = formatGrid(validFullGrid, text);
+    assert(rv == 1 + (9 * ((9 * 3) + (3 * 2) + 1)) + 3);
+    assert(rv <= GRID_TEXT_SIZE);
+    assert(strncmp(text, "\n 1  2  3    4  5  6    7  8  9   \n 1", 37) == 0);
+    assert(strncmp(&text[rv - 2], "\n\n", 2) == 0);
+    rv = formatGrid(badCharGrid, text);
+    assert(rv == 0);
+
 
     // Test printing a grid with BLANK values.
     rv = printGrid(validGrid);
@@ -209,6 +499,7 @@ static void testPrintGrid() {
     rv = printGrid(badLengthGrid);
     assert(!rv);
 }
+#endif
 
 
 
@@ -222,6 +513,13 @@ void runTests() {
     printf("Testing sudoku.c ...");
 
     // Run tests.
+    testIsValidValue();
+    testTables();
+    testScanGrid();
+    testPackGrid();
+    testOutputWriter();
+    testRing();
+#if GRID_LENGTH == 9
     testReadGrid();
     testIsFull();
     testGetBlankCell();
@@ -229,6 +527,7 @@ void runTests() {
     testSetCell();
     testClearCell();
     testPrintGrid();
+#endif
 
 
     // Print that all tests passed.